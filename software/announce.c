@@ -0,0 +1,169 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 announce.c                                */
+/*                                                                           */
+/*               Sidetone announcer for the walkie-talkie keyer              */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/* wt-keyer */
+#include "announce.h"
+#include "cw.h"
+#include "cwqueue.h"
+#include "timer.h"
+#include "tone.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Tone lengths */
+#define SUCCESS_TICKS   MSEC(70, 0)
+#define FAILURE_TICKS   MSEC(100, 0)
+
+/* The queue plays on the sidetone only */
+static CwQueue AnQ;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+bool AnnouncePut(uint16_t Item)
+/* Add an item to the announcer queue. Returns false if the queue is full. */
+{
+    return CwQueuePut(&AnQ, Item);
+}
+
+
+
+bool AnnounceChar(char C)
+/* Add an ASCII character to the announcer queue. A blank is a word space,
+ * unknown characters are ignored. Returns false if the queue is full.
+ */
+{
+    if (C == ' ') {
+        return AnnouncePut(AN_SPACE);
+    }
+    CwChar Cw = AsciiToCw(C);
+    return (Cw == 0x0000)? true : AnnouncePut(Cw);
+}
+
+
+
+bool AnnounceString_P(const char* S)
+/* Add an ASCII string from flash to the announcer queue. Returns false if the
+ * queue is full, in which case only part of the string was added.
+ */
+{
+    char C;
+    while ((C = pgm_read_byte(S++)) != '\0') {
+        if (!AnnounceChar(C)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+static bool AnnounceDigits(uint16_t Number, uint8_t Digits)
+/* Add a number with the given digits to the announcer queue */
+{
+    if (Digits > 1 && !AnnounceDigits(Number / 10U, Digits - 1)) {
+        return false;
+    }
+    return AnnounceChar('0' + (uint8_t) (Number % 10U));
+}
+
+
+
+bool AnnounceNumber(uint16_t Number, uint8_t Digits)
+/* Add a number with the given digits followed by a word space to the
+ * announcer queue. Returns false if the queue is full, in which case only
+ * part of the number was added.
+ */
+{
+    return AnnounceDigits(Number, Digits) && AnnouncePut(AN_SPACE);
+}
+
+
+
+void AnnounceClear(void)
+/* Remove all items from the announcer queue and stop the sidetone at once */
+{
+    if (AnQ.State == CWQS_SPECIAL) {
+        EndTone();
+    }
+    CwQueueClear(&AnQ);
+}
+
+
+
+void RunAnnouncer(void)
+/* Play the announcer queue on the sidetone. Must be called in regular
+ * intervals.
+ */
+{
+    if (AnQ.State == CWQS_SPECIAL) {
+        /* Continue after the end of the tone */
+        if (SwTimerExpired(&AnQ.Timer)) {
+            EndTone();
+            CwQueueResume(&AnQ, AnQ.Timer.Expires);
+        }
+        return;
+    }
+
+    /* The special items are the success and failure tones. They are timed
+     * from the end of the pause before.
+     */
+    uint16_t Item = RunCwQueue(&AnQ);
+    if (Item == AN_SUCCESS) {
+        StartTone(TONEFREQ_SUCCESS);
+        ContinueSwTimer(&AnQ.Timer, SUCCESS_TICKS);
+    } else if (Item == AN_FAILURE) {
+        StartTone(TONEFREQ_FAILURE);
+        ContinueSwTimer(&AnQ.Timer, FAILURE_TICKS);
+    }
+}
+
+
+
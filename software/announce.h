@@ -0,0 +1,119 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 announce.h                                */
+/*                                                                           */
+/*               Sidetone announcer for the walkie-talkie keyer              */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_ANNOUNCE_H
+#define WTKEYER_ANNOUNCE_H
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "cwqueue.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Items of the announcer are CW characters or one of the special values
+ * below. A word space is the character without elements, the others have a
+ * length above CW_MAX_ELEMENTS, so they cannot be mistaken for a character.
+ */
+#define AN_SPACE        CWQ_SPACE       /* Word space */
+#define AN_SUCCESS      0xF800U         /* Success tone */
+#define AN_FAILURE      0xF801U         /* Failure tone */
+#define AN_MEMORY       CWQ_MEMORY      /* Add CWMEM_xxx for a memory */
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+bool AnnouncePut(uint16_t Item);
+/* Add an item to the announcer queue. Returns false if the queue is full. */
+
+bool AnnounceChar(char C);
+/* Add an ASCII character to the announcer queue. A blank is a word space,
+ * unknown characters are ignored. Returns false if the queue is full.
+ */
+
+bool AnnounceString_P(const char* S);
+/* Add an ASCII string from flash to the announcer queue. Returns false if the
+ * queue is full, in which case only part of the string was added.
+ */
+
+bool AnnounceNumber(uint16_t Number, uint8_t Digits);
+/* Add a number with the given digits followed by a word space to the
+ * announcer queue. Returns false if the queue is full, in which case only
+ * part of the number was added.
+ */
+
+static inline bool AnnounceSuccess(void)
+/* Add the tone that signals a successful operation to the announcer queue */
+{
+    return AnnouncePut(AN_SUCCESS);
+}
+
+static inline bool AnnounceFailure(void)
+/* Add the tone that signals a failed operation to the announcer queue */
+{
+    return AnnouncePut(AN_FAILURE);
+}
+
+void AnnounceClear(void);
+/* Remove all items from the announcer queue and stop the sidetone at once */
+
+void RunAnnouncer(void);
+/* Play the announcer queue on the sidetone. Must be called in regular
+ * intervals.
+ */
+
+
+
+/* End of announce.h */
+#endif
+
+
+
+
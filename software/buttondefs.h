@@ -0,0 +1,59 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                               buttondefs.h                                */
+/*                                                                           */
+/*                  Button definitions shared with the ISR                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_BUTTONDEFS_H
+#define WTKEYER_BUTTONDEFS_H
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Button bits as stored in Buttons by the ISR */
+#define BUTTON_NONE     0x00
+#define BUTTON_C        0x01
+#define BUTTON_1        0x02
+#define BUTTON_2        0x04
+
+
+
+/* End of buttondefs.h */
+#endif
+
+
+
@@ -46,7 +46,7 @@
 
 /* Buttons */
 volatile uint8_t Buttons;
-volatile uint8_t ChangedButtons;
+InputQueue ButtonQueue;
 
 
 
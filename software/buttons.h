@@ -42,6 +42,7 @@
 
 /* wt-keyer */
 #include "buttondefs.h"
+#include "inputq.h"
 
 
 
@@ -53,7 +54,7 @@
 
 /* Buttons */
 volatile uint8_t Buttons;
-volatile uint8_t ChangedButtons;
+InputQueue ButtonQueue;
 
 
 
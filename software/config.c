@@ -33,9 +33,8 @@
 
 
 
-#include <avr/sleep.h>
-
 /* wt-keyer */
+#include "announce.h"
 #include "buttons.h"
 #include "config.h"
 #include "cwmem.h"
@@ -70,11 +69,12 @@ static uint8_t HandleDQuery(uint16_t Unused __attribute__((unused)))
 /* Handle the D? (tx delay query) command */
 {
     /* Convert the TX delay into milliseconds */
-    uint16_t Val = (uint16_t)((TxDelay * 1000UL) / IRQ_HZ);
+    uint16_t Val = (uint16_t)((TxDelay * (uint32_t) TICK_CLOCKS +
+                               CLOCK_HZ / 2000UL) / (CLOCK_HZ / 1000UL));
 
     /* Output it */
-    AddWordPause();
-    PlayNumber(Val, 3);
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(Val, 3);
     return CMD_OK;
 }
 
@@ -94,10 +94,34 @@ static uint8_t HandleDnnn(uint16_t Delay)
 
 
 
+static uint8_t HandleGQuery(uint16_t Unused __attribute__((unused)))
+/* Handle the G? (weighting query) command */
+{
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(Weight, 2);
+    return CMD_OK;
+}
+
+
+
+static uint8_t HandleGnn(uint16_t Weight)
+/* Handle the Gnn (set weighting) command */
+{
+    if ((uint8_t)Weight < WEIGHT_MIN || (uint8_t)Weight > WEIGHT_MAX) {
+        return CMD_UNKNOWN;
+    } else {
+        SetCwWeight((uint8_t)Weight);
+        SaveCw();
+        return CMD_OK;
+    }
+}
+
+
+
 static uint8_t HandleIA(uint16_t Unused __attribute__((unused)))
 /* Handle the IA (enable iabmic a) command */
 {
-    KeyerMode = KM_IAMBIC_A;
+    SetKeyerMode(KM_IAMBIC_A);
     SaveKeyer();
     return CMD_OK;
 }
@@ -107,7 +131,7 @@ static uint8_t HandleIA(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleIB(uint16_t Unused __attribute__((unused)))
 /* Handle the IB (enable iabmic b) command */
 {
-    KeyerMode = KM_IAMBIC_B;
+    SetKeyerMode(KM_IAMBIC_B);
     SaveKeyer();
     return CMD_OK;
 }
@@ -117,23 +141,33 @@ static uint8_t HandleIB(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleIP(uint16_t Unused __attribute__((unused)))
 /* Handle the IP (enable plain iabmic) command */
 {
-    KeyerMode = KM_IAMBIC;
+    SetKeyerMode(KM_IAMBIC);
     SaveKeyer();
     return CMD_OK;
 }
 
 
 
+static uint8_t HandleLQuery(uint16_t Unused __attribute__((unused)))
+/* Handle the L? (load query) command */
+{
+    /* Read the figures first, playing them changes them */
+    uint8_t Load = GetLoad();
+    uint16_t MaxIsr = GetMaxIsrTime();
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(Load, 3);
+    AnnounceNumber(MaxIsr, 3);
+    ResetLoadStats();
+    return CMD_OK;
+}
+
+
+
 static uint8_t HandleMQuery(uint8_t Nr)
 /* Handle one of the "query memory" commands */
 {
-    StartPlayCwMem(Nr);
-    do {
-        sleep_cpu();
-        PlayCwMem();
-    } while (CwMemIsPlaying() && Buttons == BUTTON_C && Keys == KEY_NONE);
-    AbortPlayCwMem();
-    AddWordPause();
+    /* The memory ends with a word space */
+    AnnouncePut(AN_MEMORY + Nr);
     return CMD_OK;
 }
 
@@ -158,11 +192,12 @@ static uint8_t HandleMQuery2(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleM(uint8_t Nr)
 /* Handle one of the "program memory" commands */
 {
-    CwMemory M = { .Count = 0, .Buf = { 0 } };
-    TxBufferEntry Element = { .On = false };
-    bool FirstWait = true;      /* Means: Wating for the first element */
-    Timer EndTimer = StartTimer();
+    CwMemory M = { .Count = 0 };
+    Timer Off = 0;              /* End of the last element */
+    bool Space = false;         /* Word space before the next character */
+    static SwTimer EndTimer;
 
+    StartSwTimer(&EndTimer, MSEC(2000, 0));
     ResetKeyer();
     while (true) {
         /* Releasing the Cmd button will abort memory programming */
@@ -170,16 +205,12 @@ static uint8_t HandleM(uint8_t Nr)
             return CMD_UNKNOWN;
         }
 
-        /* If we didn't get any input for 2 seconds, we're done */
-        if (ElapsedTime(EndTimer) >= MSEC(2000, 0)) {
-            /* Reset the keyer to remove any waiting stuff */
+        /* If we didn't get any input for 2 seconds, we're done. The last
+         * character is complete by then. But we may have no input
+         * characters in which case we don't change the memory.
+         */
+        if (SwTimerExpired(&EndTimer)) {
             ResetKeyer();
-
-            /* There cannot be any non pause elements waiting, since a dash
-             * is 3 dit times max so the end timer cannot be triggered in
-             * this time. But we may have no input characters in which case
-             * we don't change the memory.
-             */
             if (M.Count > 0) {
                 SaveCwMem(Nr, &M);
                 return CMD_OK;
@@ -188,55 +219,39 @@ static uint8_t HandleM(uint8_t Nr)
             }
         }
 
-        sleep_cpu();
-        Keyer();
+        WaitWakeUp();
 
-        /* Wait until we have a state change */
-        if (TxBufCount(&TxBuf) == 0) {
-            continue;
+        /* Store decoded characters. Characters with too many elements are
+         * invalid and dropped, they could not be played.
+         */
+        if (Keyer()) {
+            CwChar C = GetKeyedChar();
+            if (C != CW_INV) {
+                if ((Space && !AddToCwMemory(&M, CWQ_SPACE)) ||
+                    !AddToCwMemory(&M, C)) {
+                    /* Memory overflow */
+                    return CMD_UNKNOWN;
+                }
+            }
+            Space = false;
         }
 
-        /* Action depends on this state change being the first one or not */
-        const TxBufferEntry* E = TxBufOut(&TxBuf);
-        if (FirstWait) {
-            /* If - for whatever reason - we get a pause here, we just
-             * continue waiting.
-             */
-            if (E->On) {
-                FirstWait = false;
-                Element = *E;
-            }
-        } else {
-            /* This shouldn't happen, but for safety ignore state changes that
-             * aren't really such.
-             */
-            if (E->On != Element.On) {
-                /* Reset the end timer */
-                EndTimer = StartTimer();
-
-                /* Calculate how many dit times the old state was active, then
-                 * add memory elements according to that time. Using 8 bit
-                 * calculations is sufficient here.
-                 */
-                uint16_t DitTime = ElementTime(EL_DIT);
-                uint8_t Dits = (ElapsedTime(Element.Time) + DitTime/2) / DitTime;
-                while (Dits) {
-                    /* We can add 8 dit times per entry at maximum */
-                    uint8_t Data = Element.On? 0x01 : 0x00;
-                    uint8_t DitsToAdd = (Dits <= 8)? Dits : 8;
-                    Data |= (DitsToAdd - 1) << 1;
-                    if (!AddToCwMemory(&M, Data)) {
-                        /* Memory overflow */
-                        return CMD_UNKNOWN;
-                    }
-                    Dits -= DitsToAdd;
+        /* A pause before an element that is closer to a word pause than to
+         * a character pause starts a new word.
+         */
+        while (TxBufCount(&TxBuf) > 0) {
+            const TxBufferEntry* E = TxBufOut(&TxBuf);
+            if (!E->On) {
+                Off = E->Time;
+            } else if (M.Count > 0) {
+                uint16_t WordGap = 5 * GetKeyerDitTime();
+                if ((uint16_t) (E->Time - Off) >= WordGap) {
+                    Space = true;
                 }
-                Element = *E;
             }
+            TxBufDrop(&TxBuf);
+            StartSwTimer(&EndTimer, MSEC(2000, 0));
         }
-
-        /* Drop the just handled state change */
-        TxBufDrop(&TxBuf);
     }
 }
 
@@ -258,11 +273,44 @@ static uint8_t HandleM2(uint16_t Unused __attribute__((unused)))
 
 
 
+static uint8_t HandleNQuery(uint16_t Unused __attribute__((unused)))
+/* Handle the N? (paddle glitch query) command */
+{
+    /* Read the counter first, the command itself may cause glitches */
+    uint16_t Glitches = GetPaddleGlitches();
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(Glitches, 5);
+    ResetPaddleGlitches();
+    return CMD_OK;
+}
+
+
+
+static uint8_t HandleND(uint16_t Unused __attribute__((unused)))
+/* Handle the ND (disable paddle glitch filter) command */
+{
+    PaddleFilter = false;
+    SaveCw();
+    return CMD_OK;
+}
+
+
+
+static uint8_t HandleNE(uint16_t Unused __attribute__((unused)))
+/* Handle the NE (enable paddle glitch filter) command */
+{
+    PaddleFilter = true;
+    SaveCw();
+    return CMD_OK;
+}
+
+
+
 static uint8_t HandleOQuery(uint16_t Unused __attribute__((unused)))
 /* Handle the O? (tx off delay query) command */
 {
-    AddWordPause();
-    PlayNumber(TxOffDelay, 2);
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(TxOffDelay, 2);
     return CMD_OK;
 }
 
@@ -282,11 +330,36 @@ static uint8_t HandleOnn(uint16_t Delay)
 
 
 
+static uint8_t HandleRQuery(uint16_t Unused __attribute__((unused)))
+/* Handle the R? (dah ratio query) command */
+{
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(DahRatio, 2);
+    return CMD_OK;
+}
+
+
+
+static uint8_t HandleRnn(uint16_t Ratio)
+/* Handle the Rnn (set dah ratio) command */
+{
+    if ((uint8_t)Ratio < RATIO_MIN || (uint8_t)Ratio > RATIO_MAX) {
+        return CMD_UNKNOWN;
+    } else {
+        SetCwRatio((uint8_t)Ratio);
+        SaveCw();
+        return CMD_OK;
+    }
+}
+
+
+
 static uint8_t HandleSK(uint16_t Unused __attribute__((unused)))
 /* Handle the SK (straight key) command */
 {
     StraightKey = true;
     PaddleSwapped = false;      /* Set but don't save */
+    ResetKeyer();               /* Continue with the straight key */
     return CMD_OK;
 }
 
@@ -315,8 +388,8 @@ static uint8_t HandleSWE(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleTQuery(uint16_t Unused __attribute__((unused)))
 /* Handle the T? (tone frequency query) command */
 {
-    AddWordPause();
-    PlayNumber(ToneFreq, 3);
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(ToneFreq, 3);
     return CMD_OK;
 }
 
@@ -359,21 +432,9 @@ static uint8_t HandleTME(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleVQuery(uint16_t Unused __attribute__((unused)))
 /* Handle the V? (version query) command */
 {
-    const char* V = SVNRev;
-    char C;
-    AddWordPause();
-    while ((C = pgm_read_byte(V++)) != '\0') {
-        if (C == ' ') {
-            AddWordPause();
-        } else {
-            PlayCwChar(AsciiToCw(C));
-        }
-        /* Since the output is quite long, allow to abort it */
-        if ((Buttons & BUTTON_C) == 0) {
-            return CMD_UNKNOWN;
-        }
-    }
-    AddWordPause();
+    AnnouncePut(AN_SPACE);
+    AnnounceString_P(SVNRev);
+    AnnouncePut(AN_SPACE);
     return CMD_OK;
 }
 
@@ -382,8 +443,8 @@ static uint8_t HandleVQuery(uint16_t Unused __attribute__((unused)))
 static uint8_t HandleWQuery(uint16_t Unused __attribute__((unused)))
 /* Handle the W? (wpm query) command */
 {
-    AddWordPause();
-    PlayNumber(Wpm, 2);
+    AnnouncePut(AN_SPACE);
+    AnnounceNumber(Wpm, 2);
     return CMD_OK;
 }
 
@@ -396,28 +457,36 @@ static uint8_t HandleWnn(uint16_t Wpm)
         return CMD_UNKNOWN;
     } else {
         SetCwWpm((uint8_t)Wpm);
-        SaveCw();
+        SaveCwWpm();
         return CMD_OK;
     }
 }
 
 
 
-static uint8_t HandleCmd(CwChar* Buf, uint8_t Len)
+static uint8_t HandleCmd(const char* Buf, uint8_t Len)
 /* Handle a command and return one of the CMD_xxx codes */
 {
     /* Command list:
      * - D?             query the tx delay
      * - Dnnn           set tx delay in ms
+     * - G?             query the weighting
+     * - Gnn            set the weighting in percent (50 = standard)
      * - IA             activate iambic A
      * - IB             activate iambic B
      * - IP             activate plain iambic mode
+     * - L?             query cpu load and longest ISR time
      * - M?1            query cw memory 1
      * - M?2            query cw memory 2
      * - M1...          program cw memory 1
      * - M2...          program cw memory 2
+     * - N?             query and reset the paddle glitch counter
+     * - ND             disable the paddle glitch filter
+     * - NE             enable the paddle glitch filter
      * - O?             query tx off delay in dits
      * - Onn            set tx off delay in dits
+     * - R?             query the dah to dit ratio
+     * - Rnn            set the dah to dit ratio in tenths (30 = standard)
      * - SK             switch to straight key
      * - SWD            disable paddle swap
      * - SWE            enable paddle swap
@@ -436,31 +505,39 @@ static uint8_t HandleCmd(CwChar* Buf, uint8_t Len)
      */
     typedef struct {
         uint8_t Len;
-        CwChar  Cmd[4];
+        char    Cmd[4];         /* '#' is a digit */
         uint8_t (*Handler)(uint16_t);
     } CmdEntry;
     static const CmdEntry Cmds[] PROGMEM = {
-        { 2, {  CW_D,   CW_QM,                  }, HandleDQuery     },
-        { 4, {  CW_D,   CW_DIG, CW_DIG, CW_DIG, }, HandleDnnn       },
-        { 2, {  CW_I,   CW_A,                   }, HandleIA         },
-        { 2, {  CW_I,   CW_B,                   }, HandleIB         },
-        { 2, {  CW_I,   CW_P,                   }, HandleIP         },
-        { 3, {  CW_M,   CW_QM,  CW_1,           }, HandleMQuery1    },
-        { 3, {  CW_M,   CW_QM,  CW_2,           }, HandleMQuery2    },
-        { 2, {  CW_M,   CW_1,                   }, HandleM1         },
-        { 2, {  CW_M,   CW_2,                   }, HandleM2         },
-        { 2, {  CW_O,   CW_QM,                  }, HandleOQuery     },
-        { 3, {  CW_O,   CW_DIG, CW_DIG,         }, HandleOnn        },
-        { 3, {  CW_S,   CW_W,   CW_D,           }, HandleSWD        },
-        { 3, {  CW_S,   CW_W,   CW_E,           }, HandleSWE        },
-        { 2, {  CW_S,   CW_K,                   }, HandleSK         },
-        { 2, {  CW_T,   CW_QM,                  }, HandleTQuery     },
-        { 4, {  CW_T,   CW_DIG, CW_DIG, CW_DIG, }, HandleTnnn       },
-        { 3, {  CW_T,   CW_M,   CW_D,           }, HandleTMD        },
-        { 3, {  CW_T,   CW_M,   CW_E,           }, HandleTME        },
-        { 2, {  CW_V,   CW_QM,                  }, HandleVQuery     },
-        { 2, {  CW_W,   CW_QM,                  }, HandleWQuery     },
-        { 3, {  CW_W,   CW_DIG, CW_DIG,         }, HandleWnn        },
+        { 2, "D?",      HandleDQuery     },
+        { 4, "D###",    HandleDnnn       },
+        { 2, "G?",      HandleGQuery     },
+        { 3, "G##",     HandleGnn        },
+        { 2, "IA",      HandleIA         },
+        { 2, "IB",      HandleIB         },
+        { 2, "IP",      HandleIP         },
+        { 2, "L?",      HandleLQuery     },
+        { 3, "M?1",     HandleMQuery1    },
+        { 3, "M?2",     HandleMQuery2    },
+        { 2, "M1",      HandleM1         },
+        { 2, "M2",      HandleM2         },
+        { 2, "N?",      HandleNQuery     },
+        { 2, "ND",      HandleND         },
+        { 2, "NE",      HandleNE         },
+        { 2, "O?",      HandleOQuery     },
+        { 3, "O##",     HandleOnn        },
+        { 2, "R?",      HandleRQuery     },
+        { 3, "R##",     HandleRnn        },
+        { 3, "SWD",     HandleSWD        },
+        { 3, "SWE",     HandleSWE        },
+        { 2, "SK",      HandleSK         },
+        { 2, "T?",      HandleTQuery     },
+        { 4, "T###",    HandleTnnn       },
+        { 3, "TMD",     HandleTMD        },
+        { 3, "TME",     HandleTME        },
+        { 2, "V?",      HandleVQuery     },
+        { 2, "W?",      HandleWQuery     },
+        { 3, "W##",     HandleWnn        },
     };
 
     /* Safety */
@@ -476,15 +553,14 @@ static uint8_t HandleCmd(CwChar* Buf, uint8_t Len)
         uint8_t CmdLen = pgm_read_byte(&E->Len);
         if (Len <= CmdLen) {
             for (uint8_t L = 0; L < Len; ++L) {
-                CwChar C = pgm_read_word(&E->Cmd[L]);
-                CwChar B = Buf[L];
-                if (C == CW_DIG) {
-                    int8_t Val = IsCwDigit(B);
-                    if (Val < 0) {
+                char C = pgm_read_byte(&E->Cmd[L]);
+                char B = Buf[L];
+                if (C == '#') {
+                    if (B < '0' || B > '9') {
                         /* Digit required, but we don't have one */
                         goto Next;
                     }
-                    Num = Num * 10 + (uint8_t)Val;
+                    Num = Num * 10 + (B - '0');
                 } else if (B != C) {
                     goto Next;
                 }
@@ -510,21 +586,28 @@ Next:   ;
 void Configuration(void)
 /* Handle keyer configuration via morse commands */
 {
-    /* There are no commands with more than 5 cw chars, so this is safe */
-    CwChar Buf[5];
+    /* There are no commands with more than 5 chars, so this is safe */
+    char Buf[5];
     uint8_t CharCount = 0;
 
     /* Read characters */
     ResetKeyer();
-    while (Buttons == BUTTON_C && !StraightKey) {
+    while (Buttons == BUTTON_C) {
+        /* Paddle input cancels an announcement at once. This must be
+         * checked before the keyer runs, so the sidetone for a new element
+         * isn't switched off.
+         */
+        if (KeyDown(Keys) || !InputQueueEmpty(&KeyQueue)) {
+            AnnounceClear();
+        }
         if (Keyer()) {
             /* A decoded input character is waiting. Remember it. */
-            Buf[CharCount++] = GetKeyedChar();
+            Buf[CharCount++] = CwToAscii(GetKeyedChar());
             /* Check if we know the command */
             switch (HandleCmd(Buf, CharCount)) {
                 case CMD_OK:
                     /* The command is known and was handled */
-                    SuccessTone();
+                    AnnounceSuccess();
                     CharCount = 0;
                     break;
                 case CMD_MAYBE:
@@ -532,18 +615,27 @@ void Configuration(void)
                     break;
                 default:
                     /* The command is definitely unknown */
-                    FailureTone();
+                    AnnounceFailure();
                     CharCount = 0;
                     break;
             }
         }
-        sleep_cpu();
+        RunAnnouncer();
+        WaitWakeUp();
     }
 
-    /* If a partial command was aborted, signal that */
+    /* Releasing the button cancels an announcement. If a partial command
+     * was aborted, signal that. The tone is played by the main loop.
+     */
+    AnnounceClear();
     if (CharCount > 0) {
-        FailureTone();
+        AnnounceFailure();
     }
+
+    /* Button changes while in config mode must not be handled by the main
+     * loop.
+     */
+    FlushInputQueue(&ButtonQueue);
 }
 
 
@@ -34,13 +34,13 @@
 
 
 #include <stdbool.h>
+#include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include <avr/sleep.h>
 
 /* wt-keyer */
 #include "cw.h"
 #include "eeprom.h"
-#include "tone.h"
 
 
 
@@ -52,19 +52,26 @@
 
 /* PARIS has 50 dits, so ...
  * ... dit length in seconds: 60 / (50 * WPM) = 6 / (5 * WPM)
- * dit length in timer increments: (6 * IRQ_HZ) / (5 * WPM)
- * Since IRQ_HZ is dividable by 5: 6 * IRQ_HZ / 5 / WPM
+ * dit length in timer increments: (6 * CLOCK_HZ) / (5 * WPM * TICK_CLOCKS)
+ * Element times have ET_FRAC_BITS fraction bits. DIT_WPM is the numerator,
+ * so the dit length is DIT_WPM / WPM.
  */
-#define DIT_LENGTH(WPM)         ((uint16_t) (6UL * IRQ_HZ / 5UL / (WPM)))
+#define DIT_WPM \
+    ((uint32_t) (((6ULL << ET_FRAC_BITS) * CLOCK_HZ) / (5ULL * TICK_CLOCKS)))
 
 /* Inputs */
 volatile uint8_t Keys;
-volatile uint8_t ChangedKeys;
+InputQueue KeyQueue;
 
-/* Current WPM setting and it's dit and dah lengths */
+/* Current settings and the resulting element lengths */
 static uint8_t  eeWpm EEMEM;
+static uint8_t  eeWeight EEMEM;
+static uint8_t  eeDahRatio EEMEM;
 uint8_t         Wpm;
-uint16_t        ElementTimes[3];
+uint8_t         Weight;
+uint8_t         DahRatio;
+uint16_t        ElementTimes[6];
+uint8_t         ElementFracs[6];
 
 /* Input from straight key? */
 bool StraightKey;
@@ -73,85 +80,10 @@ bool StraightKey;
 static uint8_t  eePaddleSwapped EEMEM;
 bool            PaddleSwapped;
 
-/* Translation table: ASCII characters to CW representation. The table is
- * sorted so doing a binary search for mapping char -> CwChar is possible
- * but we will currently search linear since the pointer calculation and
- * function overhead will eat up most of the advantages of a binary search
- * and the routines to map a character back and forth aren't used in time
- * critical situations anyway.
- */
-struct TransEntry {
-    char        C;
-    CwChar      Cw;
-};
-typedef struct TransEntry TransEntry;
-const TransEntry TransTable[] PROGMEM = {
-    { '-', CW_DASH      },
-    { '/', CW_STROKE    },
-    { '0', CW_0         },
-    { '1', CW_1         },
-    { '2', CW_2         },
-    { '3', CW_3         },
-    { '4', CW_4         },
-    { '5', CW_5         },
-    { '6', CW_6         },
-    { '7', CW_7         },
-    { '8', CW_8         },
-    { '9', CW_9         },
-    { '?', CW_QM        },
-    { 'A', CW_A         },
-    { 'B', CW_B         },
-    { 'C', CW_C         },
-    { 'D', CW_D         },
-    { 'E', CW_E         },
-    { 'F', CW_F         },
-    { 'G', CW_G         },
-    { 'H', CW_H         },
-    { 'I', CW_I         },
-    { 'J', CW_J         },
-    { 'K', CW_K         },
-    { 'L', CW_L         },
-    { 'M', CW_M         },
-    { 'N', CW_N         },
-    { 'O', CW_O         },
-    { 'P', CW_P         },
-    { 'Q', CW_Q         },
-    { 'R', CW_R         },
-    { 'S', CW_S         },
-    { 'T', CW_T         },
-    { 'U', CW_U         },
-    { 'V', CW_V         },
-    { 'W', CW_W         },
-    { 'X', CW_X         },
-    { 'Y', CW_Y         },
-    { 'Z', CW_Z         },
-    { 'a', CW_A         },
-    { 'b', CW_B         },
-    { 'c', CW_C         },
-    { 'd', CW_D         },
-    { 'e', CW_E         },
-    { 'f', CW_F         },
-    { 'g', CW_G         },
-    { 'h', CW_H         },
-    { 'i', CW_I         },
-    { 'j', CW_J         },
-    { 'k', CW_K         },
-    { 'l', CW_L         },
-    { 'm', CW_M         },
-    { 'n', CW_N         },
-    { 'o', CW_O         },
-    { 'p', CW_P         },
-    { 'q', CW_Q         },
-    { 'r', CW_R         },
-    { 's', CW_S         },
-    { 't', CW_T         },
-    { 'u', CW_U         },
-    { 'v', CW_V         },
-    { 'w', CW_W         },
-    { 'x', CW_X         },
-    { 'y', CW_Y         },
-    { 'z', CW_Z         },
-};
+/* Paddle glitch filter and counter */
+static uint8_t  eePaddleFilter EEMEM;
+bool            PaddleFilter;
+volatile uint16_t PaddleGlitches;
 
 
 
@@ -166,6 +98,8 @@ void SetupCw(void)
 {
     /* Read the wpm settings from the eeprom */
     SetCwWpm(EepromReadByte(&eeWpm, WPM_DEFAULT));
+    SetCwWeight(EepromReadByte(&eeWeight, WEIGHT_DEFAULT));
+    SetCwRatio(EepromReadByte(&eeDahRatio, RATIO_DEFAULT));
 
     /* Before reading the PaddleSwapped flag, we check if the input is a
      * straight key. We detect this from the dah input being active when
@@ -180,148 +114,199 @@ void SetupCw(void)
 
     /* Now read the remaining stuff from the eeprom */
     PaddleSwapped = EepromReadByte(&eePaddleSwapped, false);
+    PaddleFilter = EepromReadByte(&eePaddleFilter, false);
 }
 
 
 
 void SaveCw(void)
-/* Save all cw settings in the eeprom */
+/* Save all cw settings except the speed in the eeprom */
 {
-    EepromWriteByte(&eeWpm, Wpm);
+    EepromWriteByte(&eeWeight, Weight);
+    EepromWriteByte(&eeDahRatio, DahRatio);
     EepromWriteByte(&eePaddleSwapped, PaddleSwapped);
+    EepromWriteByte(&eePaddleFilter, PaddleFilter);
 }
 
 
 
-void SetCwWpm(uint8_t NewWpm)
-/* Change the WPM setting */
+uint16_t GetPaddleGlitches(void)
+/* Return the number of paddle glitches since the last reset */
 {
-    Wpm = NewWpm;
-    ElementTimes[EL_DIT] = DIT_LENGTH(Wpm);
-    ElementTimes[EL_DAH] = ElementTimes[EL_DIT] * 3;
-    ElementTimes[EL_PAUSE] = ElementTimes[EL_DIT];
+    /* The counter is changed by the ISR */
+    cli();
+    uint16_t Count = PaddleGlitches;
+    sei();
+    return Count;
 }
 
 
 
-char CwToAscii(CwChar C)
-/* Convert a CW character to its ASCII counterpart. Returns 0xFF if unknown. */
+void ResetPaddleGlitches(void)
+/* Reset the paddle glitch counter */
 {
-    /* We will always return upper case characters since these appear before
-     * their lower case equivalents in the table.
+    cli();
+    PaddleGlitches = 0;
+    sei();
+}
+
+
+
+void SaveCwWpm(void)
+/* Save the WPM setting in the eeprom */
+{
+    EepromWriteByte(&eeWpm, Wpm);
+}
+
+
+
+static void CalcElementTimes(void)
+/* Calculate the element times from the current settings */
+{
+    /* All calculations are done with fraction bits. The weighting
+     * correction is added to each mark and subtracted from the pause
+     * following it, so the overall speed doesn't change. Dividing first
+     * keeps the correction in 16 bits, the rounding error is negligible.
+     * Lengths are in tenths of a unit, the dah length is DahRatio.
      */
-    for (uint8_t I = 0; I < sizeof(TransTable)/sizeof(TransTable[0]); ++I) {
-        if (pgm_read_word(&TransTable[I].Cw) == C) {
-            return pgm_read_byte(&TransTable[I].C);
+    static const uint8_t Tenths[6] PROGMEM = { 10, 10, 0, 30, 70, 10 };
+    uint16_t Unit = (DIT_WPM + Wpm / 2) / Wpm;
+    int16_t Delta = (int16_t) (Unit / 50) * ((int8_t) Weight - 50);
+
+    for (uint8_t I = 0; I < 6; I++) {
+        uint8_t N = (I == EL_DAH)? DahRatio : pgm_read_byte(&Tenths[I]);
+        uint32_t T = 0;
+        while (N-- > 0) {
+            T += Unit;
+        }
+        T /= 10;
+        if (I == EL_DIT || I == EL_DAH) {
+            T += Delta;
+        } else if (I != ET_UNIT) {
+            T -= Delta;
         }
+
+        /* Split into whole ticks and fractions */
+        ElementTimes[I] = T >> ET_FRAC_BITS;
+        ElementFracs[I] = T & ET_FRAC_MASK;
     }
-    /* Not found */
-    return 0xFF;
 }
 
 
 
-CwChar AsciiToCw(char C)
-/* Convert an ASCII character to its CW counterpart. Returns 0 if unknown. */
+void SetCwWpm(uint8_t NewWpm)
+/* Change the WPM setting */
 {
-    for (uint8_t I = 0; I < sizeof(TransTable)/sizeof(TransTable[0]); ++I) {
-        if (pgm_read_byte(&TransTable[I].C) == C) {
-            return pgm_read_word(&TransTable[I].Cw);
-        }
+    if (NewWpm < WPM_MIN || NewWpm > WPM_MAX) {
+        NewWpm = WPM_DEFAULT;
     }
-    /* Not found */
-    return 0x0000;
+    Wpm = NewWpm;
+    CalcElementTimes();
 }
 
 
 
-static void PlayDit(void)
-/* Output one dit for config purposes */
+void SetCwWeight(uint8_t NewWeight)
+/* Change the weighting */
 {
-    SideToneStart();
-    Sleep(ElementTime(EL_DIT));
-    SideToneDone();
-    Sleep(ElementTime(EL_PAUSE));
+    if (NewWeight < WEIGHT_MIN || NewWeight > WEIGHT_MAX) {
+        NewWeight = WEIGHT_DEFAULT;
+    }
+    Weight = NewWeight;
+    CalcElementTimes();
 }
 
 
 
-static void PlayDah(void)
-/* Output one dah for config purposes */
+void SetCwRatio(uint8_t NewRatio)
+/* Change the dah to dit ratio */
 {
-    SideToneStart();
-    Sleep(ElementTime(EL_DAH));
-    SideToneDone();
-    Sleep(ElementTime(EL_PAUSE));
+    if (NewRatio < RATIO_MIN || NewRatio > RATIO_MAX) {
+        NewRatio = RATIO_DEFAULT;
+    }
+    DahRatio = NewRatio;
+    CalcElementTimes();
 }
 
 
 
-void PlayCwChar(CwChar C)
-/* Play a CW character on the sidetone */
+uint16_t NextElementTime(uint8_t* Frac, uint8_t Element)
+/* Return the time for the next code element in a sequence. Frac accumulates
+ * the fractional ticks, so the average element length is exact.
+ */
 {
-    while (C != 0x0000) {
-        switch (C >> 14) {
-            case EL_DIT:        PlayDit();      break;
-            case EL_DAH:        PlayDah();      break;
-            default:            ;       /* Ignore the pause */
-        }
-        C <<= 2;
-    }
-    /* Make the pause 3 dit lengths total */
-    Sleep(2 * ElementTime(EL_PAUSE));
+    uint16_t F = *Frac + ElementFracs[Element];
+    *Frac = F & ET_FRAC_MASK;
+    return ElementTimes[Element] + (F >> ET_FRAC_BITS);
 }
 
 
 
-static void PlayNumberInt(uint16_t Number, uint8_t Digits)
-/* Play a number with the given digits on the sidetone. Internal function. */
+static uint8_t TreeIndex(CwChar C)
+/* Return the index of a character with at most CWT_MAX_ELEMENTS elements in
+ * the Morse tree.
+ */
 {
-    if (Digits > 1) {
-        PlayNumberInt(Number / 10U, Digits - 1);
-    }
-    switch ((uint8_t) (Number % 10)) {
-        case 0: PlayCwChar(CW_0); break;
-        case 1: PlayCwChar(CW_1); break;
-        case 2: PlayCwChar(CW_2); break;
-        case 3: PlayCwChar(CW_3); break;
-        case 4: PlayCwChar(CW_4); break;
-        case 5: PlayCwChar(CW_5); break;
-        case 6: PlayCwChar(CW_6); break;
-        case 7: PlayCwChar(CW_7); break;
-        case 8: PlayCwChar(CW_8); break;
-        case 9: PlayCwChar(CW_9); break;
+    uint8_t Len = CwLength(C);
+    return (1U << Len) | (C & ((1U << Len) - 1));
+}
+
+
+
+char CwToAscii(CwChar C)
+/* Convert a CW character to its ASCII counterpart. Returns 0xFF if unknown. */
+{
+    if (CwLength(C) > CWT_MAX_ELEMENTS) {
+        return 0xFF;
     }
+    char A = pgm_read_byte(&CwTree[TreeIndex(C)]);
+    return (A > CWT_SIGN)? A : 0xFF;
 }
 
 
 
-void PlayNumber(uint16_t Number, uint8_t Digits)
-/* Play a number with the given digits on the sidetone */
+CwChar AsciiToCw(char C)
+/* Convert an ASCII character to its CW counterpart. Returns 0 if unknown. */
 {
-    PlayNumberInt(Number, Digits);
-    /* Make the pause 7 dit lengths total */
-    AddWordPause();
+    if (C >= 'a' && C <= 'z') {
+        C -= 'a' - 'A';
+    }
+    if (C < CWT_ASCII_FIRST || C > CWT_ASCII_LAST) {
+        return 0x0000;
+    }
+
+    /* The table holds the index in the Morse tree, which is the character
+     * with the length replaced by a marker bit above the elements.
+     */
+    uint8_t I = pgm_read_byte(&CwAsciiTable[C - CWT_ASCII_FIRST]);
+    if (I == 0) {
+        return 0x0000;
+    }
+    uint8_t Len = CWT_MAX_ELEMENTS;
+    while ((I & (1U << Len)) == 0) {
+        --Len;
+    }
+    return ((CwChar) Len << CW_LEN_SHIFT) | (I & ~(1U << Len));
 }
 
 
 
-int8_t IsCwDigit(CwChar C)
-/* If this is a CW digit, return its value, otherwise return -1 */
+CwChar CwDecodeElement(CwChar C, uint8_t Element)
+/* Append a code element to a character. The elements are not checked
+ * against the known characters. Returns CW_INV if the character gets too
+ * long.
+ */
 {
-    switch (C) {
-        case CW_0: return 0;
-        case CW_1: return 1;
-        case CW_2: return 2;
-        case CW_3: return 3;
-        case CW_4: return 4;
-        case CW_5: return 5;
-        case CW_6: return 6;
-        case CW_7: return 7;
-        case CW_8: return 8;
-        case CW_9: return 9;
-        default:   return -1;
+    /* Any number of dits from eight on is the error sign */
+    if (C == CW_ERR && Element == EL_DIT) {
+        return CW_ERR;
+    }
+    if (CwLength(C) >= CW_MAX_ELEMENTS ||
+        (Element != EL_DIT && Element != EL_DAH)) {
+        return CW_INV;
     }
+    return ((C + (1U << CW_LEN_SHIFT)) & ~CW_ELEMENT_MASK) |
+           ((C << 1) & CW_ELEMENT_MASK) | (Element == EL_DAH);
 }
 
 
@@ -42,6 +42,8 @@
 #include <stdint.h>
 
 /* wt-keyer */
+#include "cwtables.h"
+#include "inputq.h"
 #include "timer.h"
 
 
@@ -52,21 +54,54 @@
 
 
 
-/* We allow adjustments from 12 WPM to 40 WPM */
-#define WPM_MIN                 12
-#define WPM_MAX                 40
+/* We allow adjustments from 5 WPM to 99 WPM */
+#define WPM_MIN                 5
+#define WPM_MAX                 99
 #define WPM_DEFAULT             20
 
+/* Weighting in percent. 50 is the standard weight, higher values lengthen
+ * marks and shorten spaces by the same amount.
+ */
+#define WEIGHT_MIN              30
+#define WEIGHT_MAX              70
+#define WEIGHT_DEFAULT          50
+
+/* Dah to dit ratio in tenths */
+#define RATIO_MIN               25
+#define RATIO_MAX               45
+#define RATIO_DEFAULT           30
+
 /* Inputs */
 #define KEY_NONE                0x00
 #define KEY_DIT                 0x01
 #define KEY_DAH                 0x02
 volatile uint8_t Keys;
-volatile uint8_t ChangedKeys;
+InputQueue KeyQueue;
 
-/* Current WPM setting and the element lengths */
+/* Current settings and the resulting element lengths, indexed by the code
+ * elements below or the ET_xxx constants.
+ */
 uint8_t Wpm;
-uint16_t ElementTimes[3];
+uint8_t Weight;
+uint8_t DahRatio;
+uint16_t ElementTimes[6];
+uint8_t ElementFracs[6];
+
+/* Number of fraction bits in the element times. Chosen so that the dit
+ * length at WPM_MIN with fraction still fits into 16 bits.
+ */
+#if IRQ_HZ <= 1000
+#  define ET_FRAC_BITS  8
+#elif IRQ_HZ <= 2000
+#  define ET_FRAC_BITS  7
+#elif IRQ_HZ <= 4000
+#  define ET_FRAC_BITS  6
+#elif IRQ_HZ <= 8000
+#  define ET_FRAC_BITS  5
+#else
+#  define ET_FRAC_BITS  4
+#endif
+#define ET_FRAC_MASK    ((1U << ET_FRAC_BITS) - 1)
 
 /* Input from straight key? */
 bool StraightKey;
@@ -74,77 +109,45 @@ bool StraightKey;
 /* Paddles swapped? */
 bool PaddleSwapped;
 
+/* Filter single sample glitches on the paddle inputs? */
+bool PaddleFilter;
+
+/* Number of single sample glitches seen on the paddle inputs, counted with
+ * and without filter. Updated by the ISR, saturates at 0xFFFF.
+ */
+volatile uint16_t PaddleGlitches;
+
 /* Code elements */
 #define         EL_PAUSE        0x00U
 #define         EL_DIT          0x01U
 #define         EL_DAH          0x02U
 #define         EL_INV          0x03U   /* Invalid */
 
-/* One CW encoded character. Uses up to 8 two bit code elements in an uint16_t.
- * Last element in lsb. Unused elements are filled with EL_PAUSE.
+/* Additional indices into ElementTimes[]. The pauses include the weighting
+ * correction, the unit is the unweighted dit length.
+ */
+#define         ET_CHAR_PAUSE   0x03U   /* Pause between characters */
+#define         ET_WORD_PAUSE   0x04U   /* Pause between words */
+#define         ET_UNIT         0x05U   /* Unweighted dit length */
+
+/* One CW encoded character. The upper four bits hold the number of elements,
+ * the lower twelve bits one bit per element, set for a dah. The last element
+ * is in the lsb. Zero is a character without elements. Lengths above
+ * CW_MAX_ELEMENTS are used for the special values below.
  */
 typedef uint16_t CwChar;
+#define CW_LEN_SHIFT            12
+#define CW_ELEMENT_MASK         0x0FFFU
+#define CW_MAX_ELEMENTS         12
 
-/* Macros to generate characters consisting of some number of elements */
-#define CWC_1(e1) \
-        (e1)
-#define CWC_2(e1, e2) \
-        (((e1) << 2) | (e2))
-#define CWC_3(e1, e2, e3) \
-        (((e1) << 4) | ((e2) << 2) | (e3))
-#define CWC_4(e1, e2, e3, e4) \
-        (((e1) << 6) | ((e2) << 4) | ((e3) << 2) | (e4))
-#define CWC_5(e1, e2, e3, e4, e5) \
-        (((e1) << 8) | ((e2) << 6) | ((e3) << 4) | ((e4) << 2) | (e5))
-#define CWC_6(e1, e2, e3, e4, e5, e6) \
-        (((e1) << 10) | ((e2) << 8) | ((e3) << 6) | ((e4) << 4) | ((e5) << 2) | (e6))
-
-/* Macros for some CW characters. The first two aren't real characters.
+/* Special values that aren't real characters.
  * CW_INV is used a read cw character as "invalid".
- * CW_DIG is a placeholder used in the config routines when reading input
- * that expects a number (like the Wnn command).
+ * The real characters are defined in cw.def, from which the CW_xxx macros
+ * in cwtables.h are generated. CW_ERR and CW_SOS are prosigns without an
+ * ASCII counterpart. The error sign is eight or more dits, a decoded one is
+ * always CW_ERR.
  */
 #define CW_INV    0xFFFF
-#define CW_DIG    0xF000
-#define CW_DASH   CWC_6(EL_DAH, EL_DIT, EL_DIT, EL_DIT, EL_DIT, EL_DAH)
-#define CW_STROKE CWC_5(EL_DAH, EL_DIT, EL_DIT, EL_DAH, EL_DIT)
-#define CW_1      CWC_5(EL_DIT, EL_DAH, EL_DAH, EL_DAH, EL_DAH)
-#define CW_2      CWC_5(EL_DIT, EL_DIT, EL_DAH, EL_DAH, EL_DAH)
-#define CW_3      CWC_5(EL_DIT, EL_DIT, EL_DIT, EL_DAH, EL_DAH)
-#define CW_4      CWC_5(EL_DIT, EL_DIT, EL_DIT, EL_DIT, EL_DAH)
-#define CW_5      CWC_5(EL_DIT, EL_DIT, EL_DIT, EL_DIT, EL_DIT)
-#define CW_6      CWC_5(EL_DAH, EL_DIT, EL_DIT, EL_DIT, EL_DIT)
-#define CW_7      CWC_5(EL_DAH, EL_DAH, EL_DIT, EL_DIT, EL_DIT)
-#define CW_8      CWC_5(EL_DAH, EL_DAH, EL_DAH, EL_DIT, EL_DIT)
-#define CW_9      CWC_5(EL_DAH, EL_DAH, EL_DAH, EL_DAH, EL_DIT)
-#define CW_0      CWC_5(EL_DAH, EL_DAH, EL_DAH, EL_DAH, EL_DAH)
-#define CW_QM     CWC_6(EL_DIT, EL_DIT, EL_DAH, EL_DAH, EL_DIT, EL_DIT)
-#define CW_A      CWC_2(EL_DIT, EL_DAH)
-#define CW_B      CWC_4(EL_DAH, EL_DIT, EL_DIT, EL_DIT)
-#define CW_C      CWC_4(EL_DAH, EL_DIT, EL_DAH, EL_DIT)
-#define CW_D      CWC_3(EL_DAH, EL_DIT, EL_DIT)
-#define CW_E      CWC_1(EL_DIT)
-#define CW_F      CWC_4(EL_DIT, EL_DIT, EL_DAH, EL_DIT)
-#define CW_G      CWC_3(EL_DAH, EL_DAH, EL_DIT)
-#define CW_H      CWC_4(EL_DIT, EL_DIT, EL_DIT, EL_DIT)
-#define CW_I      CWC_2(EL_DIT, EL_DIT)
-#define CW_J      CWC_4(EL_DIT, EL_DAH, EL_DAH, EL_DAH)
-#define CW_K      CWC_3(EL_DAH, EL_DIT, EL_DAH)
-#define CW_L      CWC_4(EL_DIT, EL_DAH, EL_DIT, EL_DIT)
-#define CW_M      CWC_2(EL_DAH, EL_DAH)
-#define CW_N      CWC_2(EL_DAH, EL_DIT)
-#define CW_O      CWC_3(EL_DAH, EL_DAH, EL_DAH)
-#define CW_P      CWC_4(EL_DIT, EL_DAH, EL_DAH, EL_DIT)
-#define CW_Q      CWC_4(EL_DAH, EL_DAH, EL_DIT, EL_DAH)
-#define CW_R      CWC_3(EL_DIT, EL_DAH, EL_DIT)
-#define CW_S      CWC_3(EL_DIT, EL_DIT, EL_DIT)
-#define CW_T      CWC_1(EL_DAH)
-#define CW_U      CWC_3(EL_DIT, EL_DIT, EL_DAH)
-#define CW_V      CWC_4(EL_DIT, EL_DIT, EL_DIT, EL_DAH)
-#define CW_W      CWC_3(EL_DIT, EL_DAH, EL_DAH)
-#define CW_X      CWC_4(EL_DAH, EL_DIT, EL_DIT,EL_DAH)
-#define CW_Y      CWC_4(EL_DAH, EL_DIT, EL_DAH, EL_DAH)
-#define CW_Z      CWC_4(EL_DAH, EL_DAH, EL_DIT, EL_DIT)
 
 
 
@@ -158,24 +161,36 @@ void SetupCw(void);
 /* Module setup */
 
 void SaveCw(void);
-/* Save all cw settings in the eeprom */
+/* Save all cw settings except the speed in the eeprom */
+
+uint16_t GetPaddleGlitches(void);
+/* Return the number of paddle glitches since the last reset */
+
+void ResetPaddleGlitches(void);
+/* Reset the paddle glitch counter */
+
+void SaveCwWpm(void);
+/* Save the WPM setting in the eeprom */
 
 void SetCwWpm(uint8_t NewWpm);
 /* Change the WPM setting */
 
+void SetCwWeight(uint8_t NewWeight);
+/* Change the weighting */
+
+void SetCwRatio(uint8_t NewRatio);
+/* Change the dah to dit ratio */
+
 static inline uint16_t ElementTime(uint8_t Element)
 /* Return the time for one code element */
 {
     return ElementTimes[Element];
 }
 
-static inline void AddWordPause(void)
-/* Add enough pause to convert a character pause (3 dits) into a word pause
- * (7 dits).
+uint16_t NextElementTime(uint8_t* Frac, uint8_t Element);
+/* Return the time for the next code element in a sequence. Frac accumulates
+ * the fractional ticks, so the average element length is exact.
  */
-{
-    Sleep(4 * ElementTime(EL_PAUSE));
-}
 
 char CwToAscii(CwChar C);
 /* Convert a CW character to its ASCII counterpart. Returns 0xFF if unknown. */
@@ -183,14 +198,30 @@ char CwToAscii(CwChar C);
 CwChar AsciiToCw(char C);
 /* Convert an ASCII character to its CW counterpart. Returns 0 if unknown. */
 
-void PlayCwChar(CwChar C);
-/* Play a CW character on the sidetone */
+CwChar CwDecodeElement(CwChar C, uint8_t Element);
+/* Append a code element to a character. The elements are not checked
+ * against the known characters. Returns CW_INV if the character gets too
+ * long.
+ */
 
-void PlayNumber(uint16_t Number, uint8_t Digits);
-/* Play a number with the given digits on the sidetone */
+static inline uint8_t CwLength(CwChar C)
+/* Return the number of elements in a character */
+{
+    return C >> CW_LEN_SHIFT;
+}
 
-int8_t IsCwDigit(CwChar C);
-/* If this is a CW digit, return its value, otherwise return -1 */
+static inline uint8_t CwFirstElement(CwChar C)
+/* Return the first element of a character that has at least one */
+{
+    return (C & (1U << (CwLength(C) - 1)))? EL_DAH : EL_DIT;
+}
+
+static inline CwChar CwRemoveFirst(CwChar C)
+/* Remove the first element from a character that has at least one */
+{
+    uint8_t Len = CwLength(C) - 1;
+    return ((CwChar) Len << CW_LEN_SHIFT) | (C & ((1U << Len) - 1));
+}
 
 static inline bool Dit(uint8_t Keys)
 /* Check if dit was pressed */
@@ -204,6 +235,14 @@ static inline bool Dah(uint8_t Keys)
     return (Keys & KEY_DAH) != KEY_NONE;
 }
 
+static inline bool KeyDown(uint8_t Keys)
+/* Check if the paddle or straight key is pressed. If a straight key is used,
+ * dah may be tied to ground and is ignored.
+ */
+{
+    return Dit(Keys) || (!StraightKey && Dah(Keys));
+}
+
 
 
 /* End of cw.h */
@@ -33,13 +33,12 @@
 
 
 
+/* wt-keyer */
 /* wt-keyer */
 #include "cw.h"
 #include "cwmem.h"
+#include "cwqueue.h"
 #include "eeprom.h"
-#include "timer.h"
-#include "txbuffer.h"
-#include "tone.h"
 
 
 
@@ -55,12 +54,9 @@ static CwMemory eeCwMem[CWMEM_MAX] EEMEM;
 /* Cached message lengths */
 static uint16_t CwMemLen[CWMEM_MAX];
 
-/* Play state variables */
-uint8_t CwMemState;
-uint8_t CwMemCur;
-uint16_t CwMemIndex;
-static uint16_t CwMemWaitTime;
-static Timer CwMemTimer;
+/* Memory read by NextCwMemChar() */
+static uint8_t CwMemCur;
+static uint8_t CwMemIndex;
 
 
 
@@ -86,7 +82,7 @@ void SaveCwMem(uint8_t Number, const CwMemory* M)
 /* Save cw memory data to eeprom */
 {
     /* Update the data in eeprom */
-    uint16_t Count = sizeof(M->Count) + (M->Count + 1) / 2;
+    uint16_t Count = sizeof(M->Count) + M->Count * sizeof(CwChar);
     eeprom_update_block(M, &eeCwMem[Number - 1], Count);
 
     /* Update the cached length */
@@ -95,85 +91,30 @@ void SaveCwMem(uint8_t Number, const CwMemory* M)
 
 
 
-void PlayCwMem(void)
-/* Play a cw memory. Places the necessary data into TxBuf so that the morse
- * code can be sent. Must be called in regular intervals until the buffer is
- * output completely.
- */
+void StartCwMem(uint8_t Number)
+/* Start reading a cw memory with NextCwMemChar() */
 {
-    do {
-        const uint8_t* DataPtr;
-        uint8_t Data;
-
-        switch (CwMemState) {
-
-            case CMS_IDLE:
-                break;
-
-            case CMS_INIT:
-                /* Check if we have more data to play */
-                if (CwMemIndex >= CwMemLen[CwMemCur - 1]) {
-                    /* Done playing this memory */
-                    CwMemState = CMS_IDLE;
-                    break;
-                }
-
-                /* Get a pointer to the next data byte in eeprom */
-                DataPtr = eeCwMem[CwMemCur - 1].Buf + CwMemIndex / 2;
-
-                /* Read the next element and bump the data index */
-                Data = EepromReadByte(DataPtr, 0x22);
-                if (CwMemIndex & 0x01) {
-                    /* Relevant data is in the high nibble */
-                    Data >>= 4;
-                } else {
-                    /* Relevant data is in the low nibble */
-                    Data &= 0x0F;
-                }
-                ++CwMemIndex;
-
-                /* Setup the timer, activate the tone */
-                CwMemWaitTime = ((Data >> 1) + 1) * ElementTime(EL_DIT);
-                CwMemTimer = StartTimer();
-                if (Data & 0x01) {
-                    TxBufPush(&TxBuf, StartTimer(), true);
-                    SideToneStart();
-                    CwMemState = CMS_ELEMENT;
-                } else {
-                    CwMemState = CMS_PAUSE;
-                }
-                break;
-
-            case CMS_ELEMENT:
-                if (ElapsedTime(CwMemTimer) >= CwMemWaitTime) {
-                    TxBufPush(&TxBuf, StartTimer(), false);
-                    SideToneDone();
-                    CwMemState = CMS_INIT;
-                    continue;
-                }
-                break;
-
-            case CMS_PAUSE:
-                if (ElapsedTime(CwMemTimer) >= CwMemWaitTime) {
-                    CwMemState = CMS_INIT;
-                    continue;
-                }
-                break;
-
-        }
-
-    } while (false);
+    CwMemCur = Number - 1;
+    CwMemIndex = 0;
 }
 
 
 
-void AbortPlayCwMem(void)
-/* Abort playing a cw memory. */
+uint16_t NextCwMemChar(void)
+/* Return the next character of the memory started with StartCwMem(). The
+ * last character is followed by a word space, then CWQ_NONE is returned.
+ */
 {
-    CwMemCur = CWMEM_NONE;
-    CwMemIndex = 0;
-    CwMemState = CMS_IDLE;
-    SideToneDone();             /* In case we were playing */
+    /* A memory saved in another format may have an invalid length */
+    uint8_t Len = (CwMemLen[CwMemCur] <= CWMEM_MAX_CHARS)?
+                  CwMemLen[CwMemCur] : 0;
+    if (CwMemIndex < Len) {
+        return eeprom_read_word(&eeCwMem[CwMemCur].Buf[CwMemIndex++]);
+    } else if (CwMemIndex == Len && Len > 0) {
+        ++CwMemIndex;
+        return CWQ_SPACE;
+    }
+    return CWQ_NONE;
 }
 
 
@@ -41,6 +41,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* wt-keyer */
+#include "cw.h"
+
 
 
 /*****************************************************************************/
@@ -49,28 +52,16 @@
 
 
 
-/* Maximum number of elements that can be stored. Each element has one bit
- * that says "active" or not. Three more bits encode the length in dit lengths
- * for the current speed plus one (since we don't need zero length elements).
- * Some examples:
- *
- * dit: length=1, active=1, value = 0x01
- * dah: length=3, active=1, value = 0x06
- * inter element pause: length=1, active=0, value=0x00
- * inter char pause: length=3, active=0, value=0x04
- * inter word pause: length=7, active=0, value=0x0C
- *
- * A pause that is longer than 8 dits would be encoded in more elements.
- * Since we store one such element per nibble, the maximum total number is
- * always even. The ATMega8 has 512 bytes of eeprom which is partly used by
- * other data. So the maximum we can use is somewhere between 400 and 500
- * bytes meaning twice as many elements as defined above.
+/* A memory holds the keyed text as CW characters, a word space is stored as
+ * CWQ_SPACE. Memories are played by a CwQueue, so weighting and dah ratio
+ * are applied when playing. The ATMega8 has 512 bytes of eeprom which is
+ * partly used by other data, so each memory is 200 bytes.
  */
 typedef struct {
-    uint16_t    Count;          /* Number of elements(!) stored */
-    uint8_t     Buf[198];       /* Make it 200 bytes total */
+    uint16_t    Count;          /* Number of characters stored */
+    CwChar      Buf[99];        /* Make it 200 bytes total */
 } CwMemory;
-#define CWMEM_MAX_EL    (sizeof(((CwMemory*)0)->Buf) * 2U)
+#define CWMEM_MAX_CHARS (sizeof(((CwMemory*)0)->Buf) / sizeof(CwChar))
 
 /* Codes for the memories. Zero means "no memory". */
 #define CWMEM_NONE      0
@@ -78,17 +69,6 @@ typedef struct {
 #define CWMEM_2         2
 #define CWMEM_MAX       2
 
-/* Play state variables */
-enum {
-    CMS_IDLE,
-    CMS_INIT,
-    CMS_ELEMENT,
-    CMS_PAUSE,
-};
-uint8_t CwMemState;
-uint8_t CwMemCur;
-uint16_t CwMemIndex;
-
 
 
 /*****************************************************************************/
@@ -97,23 +77,15 @@ uint16_t CwMemIndex;
 
 
 
-static inline bool AddToCwMemory(CwMemory* M, uint8_t E)
-/* Add an entry to a CW memory structure. Returns true if successful, returns
- * false for a memory overflow.
+static inline bool AddToCwMemory(CwMemory* M, CwChar C)
+/* Add a character to a CW memory structure. Returns true if successful,
+ * returns false for a memory overflow.
  */
 {
-    if (M->Count >= CWMEM_MAX_EL) {
+    if (M->Count >= CWMEM_MAX_CHARS) {
         return false;
     }
-    uint16_t Index = M->Count / 2;
-    if (M->Count & 0x01) {
-        /* Data is in high nibble */
-        M->Buf[Index] |= (E <<= 4);
-    } else {
-        /* Data is in low nibble */
-        M->Buf[Index] = (E & 0x0F);
-    }
-    ++M->Count;
+    M->Buf[M->Count++] = C;
     return true;
 }
 
@@ -131,29 +103,14 @@ void SetupCwMem(void);
 void SaveCwMem(uint8_t Number, const CwMemory* M);
 /* Save cw memory data to eeprom */
 
-static inline void StartPlayCwMem(uint8_t Number)
-/* Start playing a cw memory buffer */
-{
-    CwMemCur = Number;
-    CwMemIndex = 0;
-    CwMemState = CMS_INIT;
-}
+void StartCwMem(uint8_t Number);
+/* Start reading a cw memory with NextCwMemChar() */
 
-void PlayCwMem(void);
-/* Play a cw memory. Places the necessary data into TxBuf so that the morse
- * code can be sent. Must be called in regular intervals until the buffer is
- * output completely.
+uint16_t NextCwMemChar(void);
+/* Return the next character of the memory started with StartCwMem(). The
+ * last character is followed by a word space, then CWQ_NONE is returned.
  */
 
-void AbortPlayCwMem(void);
-/* Abort playing a cw memory. */
-
-static inline bool CwMemIsPlaying(void)
-/* Check if we're currently playing back a cw memory. */
-{
-    return (CwMemState != CMS_IDLE);
-}
-
 
 
 /* End of cwmem.h */
@@ -0,0 +1,204 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 cwqueue.c                                 */
+/*                                                                           */
+/*             Queue of CW characters for the walkie-talkie keyer            */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "cwmem.h"
+#include "cwqueue.h"
+#include "timer.h"
+#include "tone.h"
+#include "txbuffer.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static void StartElement(CwQueue* Q, Timer Start)
+/* Start the next element of the current character at time Start */
+{
+    uint8_t E = (Q->Elements & 0x8000U)? EL_DAH : EL_DIT;
+    Q->Elements <<= 1;
+    Q->Count--;
+    SideToneStart();
+    if (Q->Tx) {
+        TxBufPush(&TxBuf, Start, true);
+    }
+    StartSwTimerAt(&Q->Timer, Start + NextElementTime(&Q->Frac, E));
+    Q->State = CWQS_MARK;
+}
+
+
+
+static uint16_t StartItem(CwQueue* Q, Timer Start)
+/* Start the next item from the queue at time Start. Returns a special item
+ * or CWQ_NONE.
+ */
+{
+    /* Stop if there is nothing to play or we are held. While a memory is
+     * played, its characters come before the items in the queue.
+     */
+    uint16_t Item = CWQ_NONE;
+    if (Q->Mem && !Q->Held) {
+        Item = NextCwMemChar();
+        Q->Mem = (Item != CWQ_NONE);
+    }
+    if (Item == CWQ_NONE) {
+        if (Q->Held || Q->In == Q->Out) {
+            StopSwTimer(&Q->Timer);
+            Q->State = CWQS_IDLE;
+            return CWQ_NONE;
+        }
+        Item = Q->Items[Q->Out];
+        Q->Out = (Q->Out + 1) & (CWQ_SIZE - 1);
+    }
+
+    if (Item == CWQ_SPACE) {
+        /* Extend the character pause to a word pause */
+        CwQueueResume(Q, Start + ElementTime(ET_WORD_PAUSE) -
+                         ElementTime(ET_CHAR_PAUSE));
+    } else if ((Item & 0xFF00U) == CWQ_MEMORY) {
+        /* Read the characters from the memory */
+        StartCwMem(Item & 0x00FFU);
+        Q->Mem = true;
+        CwQueueResume(Q, Start);
+    } else if (CwLength(Item) > CW_MAX_ELEMENTS) {
+        StartSwTimerAt(&Q->Timer, Start);
+        Q->State = CWQS_SPECIAL;
+        return Item;
+    } else {
+        /* Move the first element into the msb */
+        Q->Count = CwLength(Item);
+        Q->Elements = Item << (16 - Q->Count);
+        StartElement(Q, Start);
+    }
+    return CWQ_NONE;
+}
+
+
+
+bool CwQueuePut(CwQueue* Q, uint16_t Item)
+/* Add an item to a queue. Returns false if the queue is full. */
+{
+    uint8_t Next = (Q->In + 1) & (CWQ_SIZE - 1);
+    if (Next == Q->Out) {
+        return false;
+    }
+    Q->Items[Q->In] = Item;
+    Q->In = Next;
+
+    /* Make another pass to start playing */
+    WakeNow();
+    return true;
+}
+
+
+
+void CwQueueClear(CwQueue* Q)
+/* Remove all items from a queue and stop the sidetone at once. A special
+ * item must be stopped by the owner before.
+ */
+{
+    if (Q->State == CWQS_MARK) {
+        SideToneDone();
+    }
+    Q->Out = Q->In;
+    Q->Mem = false;
+    Q->State = CWQS_IDLE;
+    StopSwTimer(&Q->Timer);
+}
+
+
+
+void CwQueueResume(CwQueue* Q, Timer Start)
+/* Continue with the next item at time Start after a special item */
+{
+    StartSwTimerAt(&Q->Timer, Start);
+    Q->Count = 0;
+    Q->State = CWQS_PAUSE;
+}
+
+
+
+uint16_t RunCwQueue(CwQueue* Q)
+/* Play a queue on the sidetone. If a special item is due, it is returned,
+ * otherwise CWQ_NONE. The queue then waits in CWQS_SPECIAL with Q->Timer
+ * set to the start time of the item, until the owner calls CwQueueResume.
+ * Must be called in regular intervals.
+ */
+{
+    switch (Q->State) {
+
+        case CWQS_IDLE:
+            return StartItem(Q, StartTimer());
+
+        case CWQS_MARK:
+            /* The pause is timed from the exact end of the element, so
+             * errors don't accumulate. The last element of a character is
+             * followed by a character pause.
+             */
+            if (SwTimerExpired(&Q->Timer)) {
+                SideToneDone();
+                if (Q->Tx) {
+                    TxBufPush(&TxBuf, Q->Timer.Expires, false);
+                }
+                ContinueSwTimer(&Q->Timer, NextElementTime(&Q->Frac,
+                                Q->Count? EL_PAUSE : ET_CHAR_PAUSE));
+                Q->State = CWQS_PAUSE;
+            }
+            break;
+
+        case CWQS_PAUSE:
+            if (SwTimerExpired(&Q->Timer)) {
+                if (Q->Count != 0) {
+                    StartElement(Q, Q->Timer.Expires);
+                } else {
+                    return StartItem(Q, Q->Timer.Expires);
+                }
+            }
+            break;
+
+    }
+    return CWQ_NONE;
+}
+
+
+
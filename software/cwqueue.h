@@ -0,0 +1,134 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 cwqueue.h                                 */
+/*                                                                           */
+/*             Queue of CW characters for the walkie-talkie keyer            */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_CWQUEUE_H
+#define WTKEYER_CWQUEUE_H
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "timer.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Items in a queue are CW characters or special values. A word space is the
+ * character without elements. Special values have a length above
+ * CW_MAX_ELEMENTS, so they cannot be mistaken for a character. A memory is
+ * played by the queue, other special values are handled by the owner.
+ */
+#define CWQ_SPACE       0x0000U         /* Word space */
+#define CWQ_MEMORY      0xFE00U         /* Add CWMEM_xxx for a memory */
+#define CWQ_NONE        0xFFFFU         /* No special item is due */
+
+/* Size of a queue in items. Must be a power of two. */
+#define CWQ_SIZE        32
+
+/* Play state */
+enum {
+    CWQS_IDLE,                  /* Nothing to play */
+    CWQS_MARK,                  /* Playing a dit or dah */
+    CWQS_PAUSE,                 /* Pause after an element or character */
+    CWQS_SPECIAL,               /* Owner handles a special item */
+};
+
+/* A queue with its play state */
+typedef struct {
+    uint16_t    Items[CWQ_SIZE];
+    uint8_t     In;             /* Input index */
+    uint8_t     Out;            /* Output index */
+    uint8_t     State;          /* Play state */
+    uint8_t     Frac;           /* Fractional ticks of element times */
+    uint16_t    Elements;       /* Remaining elements, next one in the msb */
+    uint8_t     Count;          /* Number of remaining elements */
+    SwTimer     Timer;          /* End of the current element or pause */
+    bool        Tx;             /* Send the elements via TxBuf */
+    bool        Held;           /* Don't start another item */
+    bool        Mem;            /* Items come from NextCwMemChar() */
+} CwQueue;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+bool CwQueuePut(CwQueue* Q, uint16_t Item);
+/* Add an item to a queue. Returns false if the queue is full. */
+
+void CwQueueClear(CwQueue* Q);
+/* Remove all items from a queue and stop the sidetone at once. A special
+ * item must be stopped by the owner before.
+ */
+
+static inline bool CwQueueSending(const CwQueue* Q)
+/* Check if a queue is in the middle of a character or in the pause after a
+ * character that hasn't ended yet.
+ */
+{
+    return Q->State == CWQS_MARK ||
+           (Q->State == CWQS_PAUSE &&
+            (Q->Count != 0 || !SwTimerExpired(&Q->Timer)));
+}
+
+void CwQueueResume(CwQueue* Q, Timer Start);
+/* Continue with the next item at time Start after a special item */
+
+uint16_t RunCwQueue(CwQueue* Q);
+/* Play a queue on the sidetone. If a special item is due, it is returned,
+ * otherwise CWQ_NONE. The queue then waits in CWQS_SPECIAL with Q->Timer
+ * set to the start time of the item, until the owner calls CwQueueResume.
+ * Must be called in regular intervals.
+ */
+
+
+
+/* End of cwqueue.h */
+#endif
+
+
+
+
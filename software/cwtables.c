@@ -0,0 +1,33 @@
+/* This file is automagically created from cw.def. DO NOT CHANGE! */
+
+#include "cwtables.h"
+
+/* Tree index for each ASCII character */
+const uint8_t PROGMEM CwAsciiTable[46] = {
+    0x61, 0x00, 0x32, 0x3F, 0x2F, 0x27, 0x23, 0x21,
+    0x20, 0x30, 0x38, 0x3C, 0x3E, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x4C, 0x00, 0x05, 0x18, 0x1A, 0x0C,
+    0x02, 0x12, 0x0E, 0x10, 0x04, 0x17, 0x0D, 0x14,
+    0x07, 0x06, 0x0F, 0x16, 0x1D, 0x0A, 0x08, 0x03,
+    0x09, 0x11, 0x0B, 0x19, 0x1B, 0x1C,
+};
+
+/* Morse tree */
+const uint8_t PROGMEM CwTree[128] = {
+    0x00, 0x00, 0x45, 0x54, 0x49, 0x41, 0x4E, 0x4D,
+    0x53, 0x55, 0x52, 0x57, 0x44, 0x4B, 0x47, 0x4F,
+    0x48, 0x56, 0x46, 0x00, 0x4C, 0x00, 0x50, 0x4A,
+    0x42, 0x58, 0x43, 0x59, 0x5A, 0x51, 0x00, 0x00,
+    0x35, 0x34, 0x00, 0x33, 0x00, 0x00, 0x00, 0x32,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31,
+    0x36, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x37, 0x00, 0x00, 0x00, 0x38, 0x00, 0x39, 0x30,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
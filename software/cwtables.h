@@ -0,0 +1,61 @@
+/* This file is automagically created from cw.def. DO NOT CHANGE! */
+
+#ifndef WTKEYER_CWTABLES_H
+#define WTKEYER_CWTABLES_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/* CW characters */
+#define CW_A               0x2001U         /* .- */
+#define CW_B               0x4008U         /* -... */
+#define CW_C               0x400AU         /* -.-. */
+#define CW_D               0x3004U         /* -.. */
+#define CW_E               0x1000U         /* . */
+#define CW_F               0x4002U         /* ..-. */
+#define CW_G               0x3006U         /* --. */
+#define CW_H               0x4000U         /* .... */
+#define CW_I               0x2000U         /* .. */
+#define CW_J               0x4007U         /* .--- */
+#define CW_K               0x3005U         /* -.- */
+#define CW_L               0x4004U         /* .-.. */
+#define CW_M               0x2003U         /* -- */
+#define CW_N               0x2002U         /* -. */
+#define CW_O               0x3007U         /* --- */
+#define CW_P               0x4006U         /* .--. */
+#define CW_Q               0x400DU         /* --.- */
+#define CW_R               0x3002U         /* .-. */
+#define CW_S               0x3000U         /* ... */
+#define CW_T               0x1001U         /* - */
+#define CW_U               0x3001U         /* ..- */
+#define CW_V               0x4001U         /* ...- */
+#define CW_W               0x3003U         /* .-- */
+#define CW_X               0x4009U         /* -..- */
+#define CW_Y               0x400BU         /* -.-- */
+#define CW_Z               0x400CU         /* --.. */
+#define CW_0               0x501FU         /* ----- */
+#define CW_1               0x500FU         /* .---- */
+#define CW_2               0x5007U         /* ..--- */
+#define CW_3               0x5003U         /* ...-- */
+#define CW_4               0x5001U         /* ....- */
+#define CW_5               0x5000U         /* ..... */
+#define CW_6               0x5010U         /* -.... */
+#define CW_7               0x5018U         /* --... */
+#define CW_8               0x501CU         /* ---.. */
+#define CW_9               0x501EU         /* ----. */
+#define CW_DASH            0x6021U         /* -....- */
+#define CW_STROKE          0x5012U         /* -..-. */
+#define CW_QM              0x600CU         /* ..--.. */
+#define CW_ERR             0x8000U         /* ........ */
+#define CW_SOS             0x9038U         /* ...---... */
+
+/* Morse tree and ASCII table */
+#define CWT_MAX_ELEMENTS        6
+#define CWT_SIGN                0x02
+#define CWT_ASCII_FIRST         0x2D
+#define CWT_ASCII_LAST          0x5A
+
+extern const uint8_t PROGMEM CwAsciiTable[46];
+extern const uint8_t PROGMEM CwTree[128];
+
+#endif
@@ -0,0 +1,114 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 inputq.h                                  */
+/*                                                                           */
+/*               Input event queue for the walkie-talkie keyer               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_INPUTQ_H
+#define WTKEYER_INPUTQ_H
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* wt-keyer */
+#include "inputqdefs.h"
+#include "timer.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* One input change as recorded by the ISR */
+typedef struct {
+    uint8_t     State;          /* Input state after the change */
+    uint8_t     Changed;        /* Inputs that have changed */
+    Timer       Time;           /* Timer ticks when the change was seen */
+} InputEvent;
+
+/* Queue of input events. The ISR in timer-irq.S is the only producer and the
+ * only one writing In. The main program is the only consumer and the only one
+ * writing Out. So no locking is needed. If the queue is full, the ISR drops
+ * new events. The layout must match the one used in timer-irq.S.
+ */
+typedef struct {
+    volatile uint8_t    In;     /* Input index */
+    volatile uint8_t    Out;    /* Output index */
+    volatile InputEvent Buf[INPUTQ_SIZE];
+} InputQueue;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static inline bool GetInputEvent(InputQueue* Q, InputEvent* E)
+/* Remove the oldest event from the queue and store it in E. Returns false if
+ * the queue is empty.
+ */
+{
+    uint8_t Out = Q->Out;
+    if (Out == Q->In) {
+        return false;
+    }
+    *E = Q->Buf[Out];
+    Q->Out = (Out + 1) & (INPUTQ_SIZE - 1);
+    return true;
+}
+
+static inline bool InputQueueEmpty(const InputQueue* Q)
+/* Check if there are no events waiting in the queue */
+{
+    return Q->Out == Q->In;
+}
+
+static inline void FlushInputQueue(InputQueue* Q)
+/* Remove all waiting events from the queue */
+{
+    Q->Out = Q->In;
+}
+
+
+
+/* End of inputq.h */
+#endif
+
+
+
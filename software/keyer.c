@@ -61,7 +61,6 @@ uint8_t KeyerMode;
 enum States {
     ST_SETUP,
     ST_IDLE,
-    ST_EL_START,
     ST_EL,
     ST_PAUSE,
     ST_SK_OFF,
@@ -73,9 +72,21 @@ static uint8_t State;
 /* Keyer variables */
 static uint8_t Element;
 static uint8_t NextElement;
-static bool PollDit;
-static Timer T;
-static uint16_t WaitTime;
+static bool PollDit;            /* Dit first if both paddles are held */
+static SwTimer KeyerTimer;      /* Element, pause and character gap */
+static Timer ManualStart;       /* Start of a straight key mark */
+static Timer GapStart;          /* End of the last straight key mark */
+static uint8_t ElementFrac;     /* Fractional ticks of element times */
+static uint16_t SkDitTime;      /* Mark unit estimate for a straight key */
+static uint16_t SkSpaceTime;    /* Space unit estimate for a straight key */
+
+/* Handlers for the current keyer mode. KeyerFunc runs the keyer. The paddle
+ * keyer calls LatchFunc while an element is sent to decide about the next
+ * element. Both are selected when the mode changes, so the keyer doesn't
+ * have to check the mode on each call.
+ */
+static bool (*KeyerFunc)(void);
+static void (*LatchFunc)(void);
 
 /* Character buffer */
 static CwChar CharBuf;
@@ -88,192 +99,317 @@ static bool CharComplete;
 
 
 
-void SetupKeyer(void)
-/* Module setup */
+static void AddElement(uint8_t E)
+/* Add an element to the character buffer */
 {
-    /* Read the settings from the eeprom */
-    KeyerMode = EepromReadByte(&eeKeyerMode, KM_DEFAULT);
+    /* If the character was complete before and we get a new element this
+     * means that the character wasn't retrieved. Just clear it and start
+     * over.
+     */
+    if (CharComplete) {
+        CharComplete = false;
+        CharBuf = 0x0000;
+    }
 
-    /* Initialize variables */
-    TxBufClear(&TxBuf);
-    State = StraightKey? ST_SK_OFF : ST_SETUP;
-    CharBuf = 0x0000;
-    CharComplete = false;
+    /* Add the element. A character with too many elements is invalid and
+     * stays invalid. The character is complete after the character gap.
+     */
+    CharBuf = CwDecodeElement(CharBuf, E);
 }
 
 
 
-void SaveKeyer(void)
-/* Save keyer settings to eeprom */
+static void DropPaddleEvents(void)
+/* Ignore the paddle events. Used if only the paddle state counts. */
 {
-    EepromWriteByte(&eeKeyerMode, KeyerMode);
+    FlushInputQueue(&KeyQueue);
 }
 
 
 
-CwChar GetKeyedChar(void)
-/* Return and clear the keyed character */
+static uint8_t SelectIambic(void)
+/* Select the next element for the iambic modes */
 {
-    CwChar C = CharBuf;
-    CharBuf = 0x0000;
-    CharComplete = false;
-    return C;
+    /* Both paddles are checked on each call. A paddle that was pressed and
+     * released again since the last call counts, too.
+     */
+    Timer DitTime = 0;
+    Timer DahTime = 0;
+    uint8_t Fresh = KEY_NONE;
+    InputEvent E;
+    while (GetInputEvent(&KeyQueue, &E)) {
+        uint8_t Pressed = E.Changed & E.State;
+        if (Dit(Pressed)) {
+            DitTime = E.Time;
+        }
+        if (Dah(Pressed)) {
+            DahTime = E.Time;
+        }
+        Fresh |= Pressed;
+    }
+    uint8_t Down = Keys | Fresh;
+
+    /* If both paddles are down, the one that closed first wins. A paddle
+     * without a press event was closed before the other one. If both were
+     * closed before, the squeeze continues and elements alternate. Presses
+     * within the same tick give a dit.
+     */
+    if (Down == KEY_DIT + KEY_DAH) {
+        if (Fresh == KEY_DIT + KEY_DAH) {
+            PollDit = (int16_t) (DahTime - DitTime) >= 0;
+        } else if (Fresh != KEY_NONE) {
+            PollDit = (Fresh == KEY_DAH);
+        }
+        return PollDit? EL_DIT : EL_DAH;
+    } else if (Dit(Down)) {
+        return EL_DIT;
+    } else if (Dah(Down)) {
+        return EL_DAH;
+    } else {
+        return EL_PAUSE;
+    }
 }
 
 
 
-static void AddElement(uint8_t E)
-/* Add an element to the character buffer */
+static uint8_t GetPressed(void)
+/* Return the paddles pressed while sending the current element. A press
+ * counts only if it happened before the element ended, even if we see it
+ * later.
+ */
 {
-    /* If the character was complete before and we get a new element this
-     * means that the character wasn't retrieved. Just clear it and start
-     * over.
-     */
-    if (CharComplete) {
-        CharComplete = false;
-        CharBuf = E;
-        return;
+    uint8_t Pressed = KEY_NONE;
+    InputEvent E;
+    while (GetInputEvent(&KeyQueue, &E)) {
+        if ((int16_t) (E.Time - KeyerTimer.Expires) < 0) {
+            Pressed |= (E.Changed & E.State);
+        }
     }
+    return Pressed;
+}
 
-    /* We cannot add something to an already invalid char */
-    if (CharBuf == CW_INV) {
-        return;
-    }
 
-    /* Check if there is space for another element */
-    if (CharBuf & 0xC000) {
-        /* No space left */
-        CharBuf = CW_INV;
-        return;
-    }
 
-    /* Add the new element */
-    CharBuf = (CharBuf << 2) | E;
+static void LatchIambicA(void)
+/* Iambic A: Remember a dit pressed while sending a dah */
+{
+    if (Element == EL_DAH && Dit(GetPressed())) {
+        NextElement = EL_DIT;
+    }
 }
 
 
 
-bool Keyer(void)
-/* Run the keyer. Must be called in regular intervals. Returns true if a
- * decode input character is waiting that may be retrieved and cleared by
- * GetKeyedChar().
+static void LatchIambicB(void)
+/* Iambic B: Remember the opposite paddle. A paddle that was pressed and
+ * released again since the last call counts, too.
  */
 {
-    /* Read the changed keys into a local variable to avoid having to read it
-     * multiple times.
-     */
-    uint8_t LChangedKeys = ChangedKeys;
-    uint8_t LKeys = Keys;
-    ChangedKeys = 0;
+    uint8_t Down = Keys | GetPressed();
+    if (Element == EL_DAH) {
+        if (Dit(Down)) {
+            NextElement = EL_DIT;
+        }
+    } else {
+        if (Dah(Down)) {
+            NextElement = EL_DAH;
+        }
+    }
+}
+
+
+
+static bool PaddleKeyer(void)
+/* Keyer function for paddles */
+{
+    Timer Start;                /* Start of a new element */
 
     switch (State) {
 
         case ST_SETUP:
-            /* Initialize for ST_IDLE */
-Setup:      T = StartTimer();
+            /* Initialize for ST_IDLE. The character gap is timed from now. */
+            StartSwTimer(&KeyerTimer, ElementTime(ET_UNIT));
             State = ST_IDLE;
             goto Idle;
 
         case ST_IDLE:
-            /* If we have elements in the character buffer and we wait for
-             * another dit length, we had a total of 2 dit lengths pause
-             * since the last element and assume that the input character
-             * is complete.
+            /* If we have elements in the character buffer and the pause
+             * since the last element is closer to a character pause than to
+             * an element pause, we assume that the input character is
+             * complete. This is a total of 2 dit lengths.
              */
-Idle:       if (CharBuf && ElapsedTime(T) >= ElementTime(EL_PAUSE)) {
+Idle:       if (CharBuf && SwTimerExpired(&KeyerTimer)) {
                 CharComplete = true;
             }
             /* Check for paddle key presses */
-            PollDit = !PollDit;
-            if (PollDit) {
-                if (Dit(LKeys)) {
-                    Element = EL_DIT;
-                    State = ST_EL_START;
-                    goto StartElement;
-                }
-            } else {
-                if (Dah(LKeys)) {
-                    Element = EL_DAH;
-                    State = ST_EL_START;
-                    goto StartElement;
-                }
+            Element = SelectIambic();
+            if (Element != EL_PAUSE) {
+                Start = StartTimer();
+                goto StartElement;
             }
             break;
 
-        case ST_EL_START:
-            /* Start the element stored in "Element" */
-StartElement:   SideToneStart();
-            T = StartTimer();
-            TxBufPush(&TxBuf, T, true);
-            WaitTime = ElementTime(Element);
-            State = ST_EL;
+            /* Start the element stored in "Element" at tick "Start" */
+StartElement:
+            PollDit = (Element == EL_DAH);      /* Alternate on a squeeze */
+            SideToneStart();
+            TxBufPush(&TxBuf, Start, true);
+            StartSwTimerAt(&KeyerTimer,
+                           Start + NextElementTime(&ElementFrac, Element));
             NextElement = EL_PAUSE;
+            State = ST_EL;
             break;
 
         case ST_EL:
             /* We are inside an element */
-            if (KeyerMode == KM_IAMBIC_A) {
-                uint8_t KeyDown = (LChangedKeys & LKeys);
-                if (Element == EL_DAH && Dit(KeyDown)) {
-                    NextElement = EL_DIT;
-                    PollDit = true;         /* Check dah next time */
-                }
-            } else if (KeyerMode == KM_IAMBIC_B) {
-                if (Element == EL_DAH) {
-                    if (Dit(LKeys)) {
-                        NextElement = EL_DIT;
-                    }
-                } else {
-                    if (Dah(LKeys)) {
-                        NextElement = EL_DAH;
-                    }
-                }
-            }
-            if (ElapsedTime(T) >= WaitTime) {
+            LatchFunc();
+            if (SwTimerExpired(&KeyerTimer)) {
+                /* The pause is timed from the exact end of the element, so
+                 * errors don't accumulate.
+                 */
                 AddElement(Element);
                 SideToneDone();
-                T = StartTimer();
-                TxBufPush(&TxBuf, T, false);
-                WaitTime = ElementTime(EL_PAUSE);
+                TxBufPush(&TxBuf, KeyerTimer.Expires, false);
+                ContinueSwTimer(&KeyerTimer,
+                                NextElementTime(&ElementFrac, EL_PAUSE));
                 State = ST_PAUSE;
             }
             break;
 
         case ST_PAUSE:
             /* Pause after dit or dah */
-            if (ElapsedTime(T) >= WaitTime) {
+            DropPaddleEvents();
+            if (SwTimerExpired(&KeyerTimer)) {
                 Element = NextElement;
                 if (Element == EL_PAUSE) {
-                    State = ST_SETUP;
-                    goto Setup;
+                    ContinueSwTimer(&KeyerTimer, ElementTime(ET_UNIT));
+                    State = ST_IDLE;
+                    goto Idle;
                 } else {
-                    WaitTime = ElementTime(Element);
-                    State = ST_EL_START;
+                    Start = KeyerTimer.Expires;
                     goto StartElement;
                 }
             }
             break;
 
-        case ST_SK_OFF:
-            /* Straight key and key open */
-            if (LKeys & KEY_DIT) {
-                /* Key was closed */
-                SideToneStart();
-                TxBufPush(&TxBuf, StartTimer(), true);
-                State = ST_SK_ON;
-            }
-            break;
+    }
+
+    return CharComplete;
+}
 
-        case ST_SK_ON:
-            /* Straight key and key closed */
-            if ((LKeys & KEY_DIT) == 0) {
-                /* Key was opened */
-                SideToneDone();
-                TxBufPush(&TxBuf, StartTimer(), false);
-                State = ST_SK_OFF;
-            }
-            break;
 
+
+static uint16_t SkUpdate(uint16_t Estimate, uint16_t Len)
+/* Update the straight key unit estimate for marks or spaces with a new mark
+ * or space of length Len and return the new estimate.
+ */
+{
+    /* Lengths below two units count as one unit, longer ones as three units.
+     * Very long ones (tuning, a stuck key or a word space) don't change the
+     * estimate, which is a running average over about four lengths. The
+     * comparisons are arranged so they cannot overflow.
+     */
+    if (Len / 2 < 3 * Estimate) {
+        uint16_t U = (Len < 2 * Estimate)? Len : Len / 3;
+        Estimate += ((int16_t) (U - Estimate)) / 4;
+    }
+
+    /* Keep the estimate within a sane range around the keyer speed. At low
+     * speeds and high IRQ rates, four units exceed KEYER_DIT_MAX. The space
+     * estimate is at most two dits, so the character gap of two spaces
+     * stays below 0x7FFF ticks, too.
+     */
+    uint16_t Unit = ElementTime(ET_UNIT);
+    uint16_t Max = (4 * Unit < KEYER_DIT_MAX)? 4 * Unit : KEYER_DIT_MAX;
+    if (Estimate < Unit / 4) {
+        Estimate = Unit / 4;
+    } else if (Estimate > Max) {
+        Estimate = Max;
+    }
+    return Estimate;
+}
+
+
+
+static void StraightKeyChange(bool Down, Timer T)
+/* Handle a change of the straight key at time T */
+{
+    /* Ignore changes that were already seen */
+    if (Down == (State == ST_SK_ON)) {
+        return;
+    }
+
+    if (Down) {
+        /* Key was closed */
+        SideToneStart();
+        TxBufPush(&TxBuf, T, true);
+        ManualStart = T;
+        StopSwTimer(&KeyerTimer);
+        State = ST_SK_ON;
+        return;
+    }
+
+    /* Key was opened */
+    SideToneDone();
+    TxBufPush(&TxBuf, T, false);
+    State = ST_SK_OFF;
+
+    /* Marks shorter than a quarter dit are contact bounce and don't count.
+     * The pause that ends the character then runs from the end of the last
+     * real mark again.
+     */
+    uint16_t Len = T - ManualStart;
+    if (Len < SkDitTime / 4) {
+        if (CharBuf != 0) {
+            StartSwTimerAt(&KeyerTimer, GapStart + 2 * SkSpaceTime);
+        }
+        return;
+    }
+
+    /* Marks shorter than two dits are dits, longer ones are dahs. The space
+     * before the mark updates the space estimate, so the end of the
+     * character follows the operator's spacing, which often differs from
+     * the mark lengths.
+     */
+    AddElement((Len < 2 * SkDitTime)? EL_DIT : EL_DAH);
+    SkDitTime = SkUpdate(SkDitTime, Len);
+    SkSpaceTime = SkUpdate(SkSpaceTime, ManualStart - GapStart);
+    GapStart = T;
+
+    /* Element spaces three times too long look like character spaces, so
+     * the space estimate alone could settle at a third of the real one. Tie
+     * it to the mark estimate to keep it out of that trap.
+     */
+    if (SkSpaceTime < SkDitTime / 2) {
+        SkSpaceTime = SkDitTime / 2;
+    } else if (SkSpaceTime > 2 * SkDitTime) {
+        SkSpaceTime = 2 * SkDitTime;
+    }
+
+    /* A pause of two element spaces ends the character */
+    StartSwTimerAt(&KeyerTimer, T + 2 * SkSpaceTime);
+}
+
+
+
+static bool StraightKeyer(void)
+/* Keyer function for a straight key */
+{
+    /* Use the key events for exact timing. Since a mono plug ties the dah
+     * contact to ground, only the dit contact counts. If events were lost,
+     * the key state is synchronized with the current time.
+     */
+    InputEvent E;
+    while (GetInputEvent(&KeyQueue, &E)) {
+        if (Dit(E.Changed)) {
+            StraightKeyChange(Dit(E.State), E.Time);
+        }
+    }
+    StraightKeyChange(Dit(Keys), StartTimer());
+
+    /* Check for the end of the character */
+    if (State == ST_SK_OFF && CharBuf != 0 && SwTimerExpired(&KeyerTimer)) {
+        CharComplete = true;
     }
 
     return CharComplete;
@@ -281,3 +417,101 @@ StartElement:   SideToneStart();
 
 
 
+void SetupKeyer(void)
+/* Module setup */
+{
+    /* Read the settings from the eeprom */
+    SetKeyerMode(EepromReadByte(&eeKeyerMode, KM_DEFAULT));
+
+    /* Initialize variables */
+    StopSwTimer(&KeyerTimer);
+    FlushInputQueue(&KeyQueue);
+    TxBufClear(&TxBuf);
+    if (StraightKey) {
+        KeyerFunc = StraightKeyer;
+        State = ST_SK_OFF;
+        if (SkDitTime == 0) {
+            SkDitTime = ElementTime(ET_UNIT);
+            SkSpaceTime = SkDitTime;
+        }
+    } else {
+        KeyerFunc = PaddleKeyer;
+        State = ST_SETUP;
+    }
+    CharBuf = 0x0000;
+    CharComplete = false;
+}
+
+
+
+void SetKeyerMode(uint8_t Mode)
+/* Set the keyer mode for paddles. Does not save the mode to eeprom. */
+{
+    KeyerMode = Mode;
+    LatchFunc = DropPaddleEvents;
+    switch (Mode) {
+        case KM_IAMBIC_A:
+            LatchFunc = LatchIambicA;
+            break;
+        case KM_IAMBIC_B:
+            LatchFunc = LatchIambicB;
+            break;
+        default:
+            /* Plain iambic: Nothing is latched, only the paddle state at
+             * the end of the element counts.
+             */
+            KeyerMode = KM_IAMBIC;
+            break;
+    }
+}
+
+
+
+void SaveKeyer(void)
+/* Save keyer settings to eeprom */
+{
+    EepromWriteByte(&eeKeyerMode, KeyerMode);
+}
+
+
+
+bool KeyerIdle(void)
+/* Check if the keyer is idle, meaning it doesn't send an element */
+{
+    return State == ST_SETUP || State == ST_IDLE || State == ST_SK_OFF;
+}
+
+
+
+uint16_t GetKeyerDitTime(void)
+/* Return the length of a dit as keyed by the operator in ticks. The result
+ * is at most KEYER_DIT_MAX.
+ */
+{
+    return (KeyerFunc == StraightKeyer)? SkDitTime : ElementTime(ET_UNIT);
+}
+
+
+
+CwChar GetKeyedChar(void)
+/* Return and clear the keyed character */
+{
+    CwChar C = CharBuf;
+    CharBuf = 0x0000;
+    CharComplete = false;
+    return C;
+}
+
+
+
+bool Keyer(void)
+/* Run the keyer. Must be called in regular intervals. Returns true if a
+ * decode input character is waiting that may be retrieved and cleared by
+ * GetKeyedChar().
+ */
+{
+    return KeyerFunc();
+}
+
+
+
@@ -62,6 +62,11 @@
 /* Keyer mode */
 uint8_t KeyerMode;
 
+/* Upper limit for the dit length returned by GetKeyerDitTime(), so that five
+ * dits still fit into the 0x7FFF ticks a timer may run.
+ */
+#define KEYER_DIT_MAX   (0x7FFFU / 5)
+
 
 
 /*****************************************************************************/
@@ -82,6 +87,17 @@ static inline void ResetKeyer(void)
 void SaveKeyer(void);
 /* Save keyer settings to eeprom */
 
+void SetKeyerMode(uint8_t Mode);
+/* Set the keyer mode for paddles. Does not save the mode to eeprom. */
+
+bool KeyerIdle(void);
+/* Check if the keyer is idle, meaning it doesn't send an element */
+
+uint16_t GetKeyerDitTime(void);
+/* Return the length of a dit as keyed by the operator in ticks. The result
+ * is at most KEYER_DIT_MAX.
+ */
+
 CwChar GetKeyedChar(void);
 /* Return and clear the keyed character */
 
@@ -36,15 +36,16 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <avr/io.h>
-#include <avr/sleep.h>
 
 /* wt-keyer */
+#include "announce.h"
 #include "buttons.h"
 #include "config.h"
 #include "cw.h"
 #include "cwmem.h"
 #include "keyer.h"
 #include "rigctrl.h"
+#include "textq.h"
 #include "timer.h"
 #include "tone.h"
 #include "version.h"
@@ -92,69 +93,78 @@ int main(void)
     SetupIO();
     SetupCw();
     SetupCwMem();
+    SetupTextQ();
     SetupKeyer();
     SetupRigCtrl();
 
     /* Run forever */
     while (1) {
-        /* Run the keyer. If it is idle, handle switches. React only on button
-         * press, not release.
+        /* Paddle input cancels what is left of a configuration
+         * announcement before the keyer uses the sidetone.
          */
-        Keyer();
-        uint8_t B;
-        if ((B = (ChangedButtons & Buttons)) != BUTTON_NONE) {
-            /* Keyer is idle. Force TX and memory play off, then handle
-             * switches.
-             */
-            TxAbort();
-            switch (B) {
-                case BUTTON_C:
-                    AbortPlayCwMem();
-                    Configuration();
-                    break;
-
-                case BUTTON_1:
-                    if (CwMemIsPlaying()) {
-                        AbortPlayCwMem();
-                    } else {
-                        StartPlayCwMem(CWMEM_1);
-                    }
-                    break;
-
-                case BUTTON_2:
-                    if (CwMemIsPlaying()) {
-                        AbortPlayCwMem();
-                    } else {
-                        StartPlayCwMem(CWMEM_2);
-                    }
-                    break;
-
-                default:
-                    /* Ignore other button combinations */
-                    break;
+        if (KeyDown(Keys) || !InputQueueEmpty(&KeyQueue)) {
+            AnnounceClear();
+        }
+
+        /* Run the keyer, unless the text queue is in the middle of a
+         * character or the pause after it. Paddle input holds the text queue
+         * at the next character boundary, so the keyer gets its turn when
+         * the pause has ended.
+         */
+        if (!TextQSending()) {
+            Keyer();
+        }
+        if (KeyDown(Keys) || !KeyerIdle()) {
+            TextQHold();
+        }
+
+        /* Handle switches. React only on button press, not release. */
+        InputEvent E;
+        uint8_t B = BUTTON_NONE;
+        if (GetInputEvent(&ButtonQueue, &E)) {
+            /* Handle one button change per pass */
+            B = (E.Changed & E.State);
+            if (!InputQueueEmpty(&ButtonQueue)) {
+                WakeNow();
             }
-            /* Reinitialize keyer and buffer */
-            ResetKeyer();
-        } else {
-            /* Play cw memories if active */
-            if (CwMemIsPlaying()) {
-                /* Allow aborting with the paddle or straight key. Beware: If
-                 * a straight key is used, dah may be tied to ground.
+        }
+        if (B != BUTTON_NONE) {
+            AnnounceClear();
+        }
+        switch (B) {
+            case BUTTON_C:
+                /* Force TX and the text queue off, then handle the
+                 * configuration. Reinitialize keyer and buffer when done.
                  */
-                if (Dit(Keys) || (!StraightKey && Dah(Keys))) {
-                    AbortPlayCwMem();
-                } else {
-                    PlayCwMem();
-                }
-            }
-
-            /* Send elements read by the keyer */
-            TxSend();
+                TextQClear();
+                TxAbort();
+                Configuration();
+                ResetKeyer();
+                break;
+
+            case BUTTON_1:
+                /* Memories are queued, so they can be chained */
+                TextQPut(TQ_MEMORY + CWMEM_1);
+                break;
+
+            case BUTTON_2:
+                TextQPut(TQ_MEMORY + CWMEM_2);
+                break;
+
+            default:
+                /* Ignore other button combinations */
+                break;
         }
 
-        /* Clear changed buttons and wait for the next timer interrupt */
-        ChangedButtons = 0;
-        sleep_cpu();
+        /* Send the text queue and the elements read by the keyer */
+        RunTextQ();
+        TxSend();
+        RunAnnouncer();
+
+        /* Sleep until an input changes or one of the modules needs
+         * attention.
+         */
+        WaitWakeUp();
     }
 }
 
@@ -56,6 +56,15 @@ bool TrainingMode;
 static uint16_t eeTxDelay EEMEM;
 uint16_t TxDelay;
 
+/* TxBuf holds the changes until they are sent after the TX delay. A mark and
+ * the pause following it take two dits, a dit is 1200 ms / WPM long. So
+ * there are at most TXDELAY_MAX * WPM_MAX / 1200 changes within the delay,
+ * plus one on each end.
+ */
+#if TXDELAY_MAX * WPM_MAX / 1200 + 2 > TXBUF_SIZE
+  #error "TXBUF_SIZE is too small for TXDELAY_MAX at WPM_MAX"
+#endif
+
 /* Delay for disabling the transmitter if there are no more elements. Value is
  * in dit lengths.
  */
@@ -70,7 +79,9 @@ typedef enum {
     ST_PAUSE,
 } States;
 static uint8_t State;
-static Timer OffTimer;
+static SwTimer TxTimer;         /* Wakeup when the next entry is due */
+static SwTimer OffTimer;        /* Delay until TX is switched off */
+static uint8_t OffCount;        /* Remaining units of the off delay */
 
 
 
@@ -136,11 +147,13 @@ void TxSend(void)
         } else if (ElapsedTime(E->Time) >= TxDelay) {
             if (E->On) {
                 State = ST_TONE;
+                StopSwTimer(&OffTimer);
                 TxToneStart();
             } else {
                 if (State == ST_TONE) {
                     State = ST_PAUSE;
-                    OffTimer = StartTimer();
+                    OffCount = TxOffDelay;
+                    StartSwTimer(&OffTimer, ElementTime(ET_UNIT));
                 }
                 TxToneDone();
             }
@@ -148,11 +161,23 @@ void TxSend(void)
             TxBufDrop(&TxBuf);
         }
     }
-    if (State == ST_PAUSE) {
-        uint16_t TxOffTime = TxOffDelay * ElementTime(EL_PAUSE);
-        if (ElapsedTime(OffTimer) >= TxOffTime) {
+
+    /* Make sure we're called again when the next entry is due */
+    if (TxBufCount(&TxBuf) > 0) {
+        StartSwTimerAt(&TxTimer, TxBufOut(&TxBuf)->Time + TxDelay);
+    } else {
+        StopSwTimer(&TxTimer);
+    }
+
+    /* The off delay is timed unit by unit, because the whole delay exceeds
+     * the longest possible timer interval at low speeds and high IRQ_HZ.
+     */
+    if (State == ST_PAUSE && SwTimerExpired(&OffTimer)) {
+        if (--OffCount == 0) {
             State = ST_IDLE;
             DisableTx();
+        } else {
+            ContinueSwTimer(&OffTimer, ElementTime(ET_UNIT));
         }
     }
 }
@@ -164,6 +189,8 @@ void TxAbort(void)
 {
     TxToneDone();
     DisableTx();
+    StopSwTimer(&TxTimer);
+    StopSwTimer(&OffTimer);
     State = ST_IDLE;
 }
 
@@ -0,0 +1,63 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  eeprom.h                                 */
+/*                                                                           */
+/*                   EEPROM access for the host simulation                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_TEST_AVR_EEPROM_H
+#define WTKEYER_TEST_AVR_EEPROM_H
+
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+/* EEPROM variables are ordinary variables. The functions are in sim.c. */
+#define EEMEM
+
+uint8_t eeprom_read_byte(const uint8_t* Addr);
+uint16_t eeprom_read_word(const uint16_t* Addr);
+void eeprom_update_byte(uint8_t* Addr, uint8_t Val);
+void eeprom_update_word(uint16_t* Addr, uint16_t Val);
+void eeprom_update_block(const void* Src, void* Dst, size_t Count);
+
+
+
+/* End of eeprom.h */
+#endif
+
+
+
+
+
@@ -0,0 +1,86 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                    io.h                                   */
+/*                                                                           */
+/*                   I/O registers for the host simulation                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_TEST_AVR_IO_H
+#define WTKEYER_TEST_AVR_IO_H
+
+
+
+#include <stdint.h>
+
+
+
+/* Registers are plain variables defined in sim.c */
+extern volatile uint8_t DDRB, DDRC, DDRD, OCR2, PIND;
+extern volatile uint8_t PORTB, PORTC, PORTD, TCCR1A, TCCR1B, TCCR2, TCNT2;
+extern volatile uint8_t OCR1AH, OCR1AL, OCR1BH, OCR1BL, TIFR, TIMSK;
+extern volatile uint16_t ICR1, OCR1A, OCR1B;
+
+/* Register bits */
+#define FOC2 7
+#define WGM20 6
+#define COM21 5
+#define COM20 4
+#define WGM21 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define OCIE2 7
+#define OCF2 7
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define FOC1A 3
+#define FOC1B 2
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+
+
+
+/* End of io.h */
+#endif
+
+
+
+
+
@@ -0,0 +1,60 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  sleep.h                                  */
+/*                                                                           */
+/*                     Sleep mode for the host simulation                    */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_TEST_AVR_SLEEP_H
+#define WTKEYER_TEST_AVR_SLEEP_H
+
+
+
+/* wt-keyer test */
+#include "sim.h"
+
+
+
+/* Sleeping means waiting for the next timer interrupt */
+#define SLEEP_MODE_IDLE         0
+#define set_sleep_mode(Mode)
+#define sleep_enable()
+#define sleep_cpu()             SimSleep()
+
+
+
+/* End of sleep.h */
+#endif
+
+
+
+
+
@@ -0,0 +1,153 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  paris.c                                  */
+/*                                                                           */
+/*              Speed accuracy test for the walkie-talkie keyer              */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "cwqueue.h"
+#include "timer.h"
+#include "txbuffer.h"
+
+/* wt-keyer test */
+#include "sim.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Number of words sent at each speed and the allowed speed error */
+#define WORDS           100
+#define MAX_ERROR       0.001
+
+/* PARIS has 14 elements */
+#define PARIS_MARKS     14
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static double MeasureWpm(void)
+/* Send PARIS WORDS + 1 times with the current settings via a CW queue and
+ * return the speed measured from the start of the first word to the start
+ * of the last one.
+ */
+{
+    static const char Word[] = "PARIS ";
+    static CwQueue Q;
+    Q.Tx = true;
+
+    unsigned Chars = 0;
+    unsigned Marks = 0;
+    uint32_t First = 0;
+    SimReset(0, 0);
+    TxBufClear(&TxBuf);
+    while (Marks <= WORDS * PARIS_MARKS) {
+        /* Keep the queue filled */
+        while (Chars < (WORDS + 1) * (sizeof(Word) - 1)) {
+            char C = Word[Chars % (sizeof(Word) - 1)];
+            if (!CwQueuePut(&Q, (C == ' ')? CWQ_SPACE : AsciiToCw(C))) {
+                break;
+            }
+            ++Chars;
+        }
+        RunCwQueue(&Q);
+
+        /* Take the sent elements from the buffer and extend the times to
+         * 32 bits.
+         */
+        while (TxBufCount(&TxBuf) > 0) {
+            const TxBufferEntry* E = TxBufOut(&TxBuf);
+            uint32_t T = SimTicks() - (Timer) (GetTicks() - E->Time);
+            if (E->On) {
+                if (Marks == 0) {
+                    First = T;
+                } else if (Marks == WORDS * PARIS_MARKS) {
+                    CwQueueClear(&Q);
+                    return WORDS * 60.0 / SimSeconds(T - First);
+                }
+                ++Marks;
+            }
+            TxBufDrop(&TxBuf);
+        }
+        WaitWakeUp();
+    }
+    return 0.0;
+}
+
+
+
+int main(void)
+{
+    SetupTimer();
+    SetupCw();
+
+    double Worst = 0.0;
+    unsigned WorstWpm = 0;
+    unsigned Failed = 0;
+    for (unsigned W = WPM_MIN; W <= WPM_MAX; ++W) {
+        SetCwWpm(W);
+        double Wpm = MeasureWpm();
+        double Error = (Wpm - W) / W;
+        if (Error < 0) {
+            Error = -Error;
+        }
+        if (Error > Worst) {
+            Worst = Error;
+            WorstWpm = W;
+        }
+        if (Error > MAX_ERROR) {
+            printf("paris: %2u WPM measured as %.4f WPM\n", W, Wpm);
+            ++Failed;
+        }
+    }
+    printf("paris: IRQ_HZ %5u, %u words at %u..%u WPM, worst error %.4f%% "
+           "at %u WPM: %s\n", IRQ_HZ, WORDS, WPM_MIN, WPM_MAX,
+           Worst * 100.0, WorstWpm, Failed? "FAILED" : "ok");
+    return Failed? 1 : 0;
+}
+
+
+
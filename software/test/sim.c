@@ -0,0 +1,195 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   sim.c                                   */
+/*                                                                           */
+/*                   Host simulation of the keyer hardware                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdint.h>
+#include <avr/eeprom.h>
+#include <avr/io.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "sim.h"
+#include "timer.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* I/O registers */
+volatile uint8_t DDRB, DDRC, DDRD, OCR2, PIND, PORTB;
+volatile uint8_t OCR1AH, OCR1AL, OCR1BH, OCR1BL, PORTC, PORTD, TCCR1A, TCCR1B;
+volatile uint8_t TCCR2, TCNT2, TIFR, TIMSK;
+volatile uint16_t ICR1, OCR1A, OCR1B;
+
+/* Tick counter of the simulated timer interrupt */
+static uint32_t Ticks;
+
+/* Key inputs */
+static SimInputFunc Input;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static uint8_t NoInput(uint32_t Tick)
+/* Input function if none was set: No key pressed */
+{
+    (void) Tick;
+    return KEY_NONE;
+}
+
+
+
+void SimReset(uint32_t Start, SimInputFunc F)
+/* Set the tick counter to Start and use Input for the key inputs */
+{
+    Ticks = Start;
+    Input = F? F : NoInput;
+    Keys = Input(Start);
+    FlushInputQueue(&KeyQueue);
+}
+
+
+
+uint32_t SimTicks(void)
+/* Return the tick counter */
+{
+    return Ticks;
+}
+
+
+
+void SimTick(void)
+/* Run the timer interrupt once. Does what timer-irq.S does for the keys and
+ * the wakeup, without the glitch filter.
+ */
+{
+    ++Ticks;
+    if ((int16_t) ((Timer) Ticks - WakeTime) >= 0) {
+        WakeUp = 1;
+    }
+
+    uint8_t K = (Input? Input : NoInput)(Ticks);
+    uint8_t Changed = Keys ^ K;
+    Keys = K;
+    if (Changed) {
+        uint8_t Next = (KeyQueue.In + 1) & (INPUTQ_SIZE - 1);
+        if (Next != KeyQueue.Out) {
+            KeyQueue.Buf[KeyQueue.In].State = K;
+            KeyQueue.Buf[KeyQueue.In].Changed = Changed;
+            KeyQueue.Buf[KeyQueue.In].Time = (Timer) Ticks;
+            KeyQueue.In = Next;
+        }
+        WakeUp = 1;
+    }
+}
+
+
+
+void SimSleep(void)
+/* Called instead of sleep_cpu: The next thing to happen is a timer tick */
+{
+    SimTick();
+}
+
+
+
+double SimSeconds(uint32_t T)
+/* Convert ticks into seconds using the real tick rate */
+{
+    return (double) T * TICK_CLOCKS / CLOCK_HZ;
+}
+
+
+
+Timer GetTicks(void)
+/* Return the current timer ticks */
+{
+    return (Timer) Ticks;
+}
+
+
+
+LongTimer GetLongTicks(void)
+/* Return the current timer ticks as 32 bit value */
+{
+    return Ticks;
+}
+
+
+
+/* The eeprom is always erased, so all settings have their default values.
+ * Writes are ignored.
+ */
+uint8_t eeprom_read_byte(const uint8_t* Addr)
+{
+    (void) Addr;
+    return 0xFF;
+}
+
+uint16_t eeprom_read_word(const uint16_t* Addr)
+{
+    (void) Addr;
+    return 0xFFFF;
+}
+
+void eeprom_update_byte(uint8_t* Addr, uint8_t Val)
+{
+    (void) Addr;
+    (void) Val;
+}
+
+void eeprom_update_word(uint16_t* Addr, uint16_t Val)
+{
+    (void) Addr;
+    (void) Val;
+}
+
+void eeprom_update_block(const void* Src, void* Dst, size_t Count)
+{
+    (void) Src;
+    (void) Dst;
+    (void) Count;
+}
+
+
+
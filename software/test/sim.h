@@ -0,0 +1,86 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   sim.h                                   */
+/*                                                                           */
+/*                   Host simulation of the keyer hardware                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_SIM_H
+#define WTKEYER_SIM_H
+
+
+
+#include <stdint.h>
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Function that returns the state of the key inputs (KEY_xxx) for a tick.
+ * Called once per tick by the simulated timer interrupt.
+ */
+typedef uint8_t (*SimInputFunc)(uint32_t Tick);
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void SimReset(uint32_t Start, SimInputFunc Input);
+/* Set the tick counter to Start and use Input for the key inputs */
+
+uint32_t SimTicks(void);
+/* Return the tick counter */
+
+void SimTick(void);
+/* Run the timer interrupt once */
+
+void SimSleep(void);
+/* Called instead of sleep_cpu: The next thing to happen is a timer tick */
+
+double SimSeconds(uint32_t Ticks);
+/* Convert ticks into seconds using the real tick rate */
+
+
+
+/* End of sim.h */
+#endif
+
+
+
+
@@ -0,0 +1,234 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 squeeze.c                                 */
+/*                                                                           */
+/*            Squeeze resolution test for the walkie-talkie keyer            */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "keyer.h"
+#include "timer.h"
+#include "txbuffer.h"
+
+/* wt-keyer test */
+#include "sim.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Number of runs per test case */
+#define RUNS            500
+
+/* Offsets in microseconds between the first and the second paddle */
+static const unsigned Offsets[] = { 0, 100, 250, 500 };
+
+/* Ticks between two keyer calls: An idle and a busy main loop */
+static const unsigned Intervals[] = { 1, 4 };
+
+/* Iambic modes */
+static const uint8_t Modes[] = { KM_IAMBIC, KM_IAMBIC_A, KM_IAMBIC_B };
+
+/* Paddle closures for the input function. Times are in microseconds since
+ * the tick Base.
+ */
+static uint32_t Base;
+static double FirstTime;
+static double SecondTime;
+static uint8_t FirstKey;
+
+/* Random number generator state */
+static uint32_t Rand = 1;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static double Uniform(void)
+/* Return a random number in 0..1 */
+{
+    Rand ^= Rand << 13;
+    Rand ^= Rand >> 17;
+    Rand ^= Rand << 5;
+    return (Rand + 0.5) / 4294967296.0;
+}
+
+
+
+static double TickTime(uint32_t Tick)
+/* Return the time of a tick in microseconds since Base */
+{
+    return (int32_t) (Tick - Base) * SimSeconds(1) * 1e6;
+}
+
+
+
+static uint8_t PaddleInput(uint32_t Tick)
+/* Return the paddle state for a tick */
+{
+    double T = TickTime(Tick);
+    return ((T >= FirstTime)? FirstKey : KEY_NONE) |
+           ((T >= SecondTime)? (FirstKey ^ (KEY_DIT | KEY_DAH)) : KEY_NONE);
+}
+
+
+
+static uint32_t SeenTick(double T)
+/* Return the tick at which the ISR sees a paddle closed at time T */
+{
+    uint32_t Tick = Base;
+    while (TickTime(Tick) < T) {
+        ++Tick;
+    }
+    return Tick;
+}
+
+
+
+static uint8_t FirstElement(unsigned Interval)
+/* Run the keyer until the first element is complete and return it, or
+ * EL_PAUSE if there is none.
+ */
+{
+    uint32_t End = SimTicks() + 20 * ElementTime(ET_UNIT);
+    Timer On = 0;
+    bool HaveOn = false;
+    while (SimTicks() < End) {
+        Keyer();
+        while (TxBufCount(&TxBuf) > 0) {
+            const TxBufferEntry* E = TxBufOut(&TxBuf);
+            if (E->On) {
+                On = E->Time;
+                HaveOn = true;
+            } else if (HaveOn) {
+                uint16_t Len = E->Time - On;
+                return (Len < 2 * ElementTime(ET_UNIT))? EL_DIT : EL_DAH;
+            }
+            TxBufDrop(&TxBuf);
+        }
+        for (unsigned I = 1; I < Interval; ++I) {
+            SimTick();
+        }
+        WaitWakeUp();
+    }
+    return EL_PAUSE;
+}
+
+
+
+static unsigned RunCase(uint8_t Mode, unsigned Interval, unsigned Offset,
+                        uint8_t First)
+/* Run one test case and return the number of runs with the expected first
+ * element.
+ */
+{
+    unsigned Right = 0;
+    for (unsigned N = 0; N < RUNS; ++N) {
+        /* Start with an idle keyer at a random time. The first paddle closes
+         * at a random phase of the tick after the idle time, the second one
+         * Offset microseconds later.
+         */
+        Base = (uint32_t) (Uniform() * 0x10000000) + 1000;
+        FirstKey = First;
+        FirstTime = 1e9;
+        SecondTime = 1e9;
+        SimReset(Base - 1000, PaddleInput);
+        SetKeyerMode(Mode);
+        SetupKeyer();
+        while (SimTicks() < Base) {
+            Keyer();
+            SimTick();
+            WakeNow();
+            WaitWakeUp();
+        }
+        FirstTime = 1e6 * SimSeconds(1) * (1.0 + Uniform());
+        SecondTime = FirstTime + Offset;
+
+        /* Paddles seen in the same tick give a dit, otherwise the paddle
+         * closed first wins.
+         */
+        uint8_t Expected = EL_DIT;
+        if (SeenTick(FirstTime) != SeenTick(SecondTime)) {
+            Expected = (First == KEY_DIT)? EL_DIT : EL_DAH;
+        }
+        Right += (FirstElement(Interval) == Expected);
+    }
+    return Right;
+}
+
+
+
+int main(void)
+{
+    SetupTimer();
+    SetupCw();
+    SetCwWpm(20);
+
+    unsigned Failed = 0;
+    printf("squeeze: IRQ_HZ %5u, expected first element for offsets "
+           "0/100/250/500us\n", IRQ_HZ);
+    for (unsigned M = 0; M < sizeof(Modes); ++M) {
+        for (unsigned I = 0; I < sizeof(Intervals) / sizeof(Intervals[0]);
+             ++I) {
+            for (uint8_t First = KEY_DIT; First <= KEY_DAH; ++First) {
+                printf("squeeze:   mode %u, keyer every %u tick(s), %s "
+                       "first:", Modes[M], Intervals[I],
+                       (First == KEY_DIT)? "dit" : "dah");
+                for (unsigned O = 0; O < sizeof(Offsets) / sizeof(Offsets[0]);
+                     ++O) {
+                    unsigned Right = RunCase(Modes[M], Intervals[I],
+                                             Offsets[O], First);
+                    printf(" %5.1f%%", 100.0 * Right / RUNS);
+                    Failed += (Right != RUNS);
+                }
+                printf("\n");
+            }
+        }
+    }
+    printf("squeeze: %s\n", Failed? "FAILED" : "ok");
+    return Failed? 1 : 0;
+}
+
+
+
@@ -0,0 +1,292 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 straight.c                                */
+/*                                                                           */
+/*         Straight key decoder benchmark for the walkie-talkie keyer        */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* The keyer is included, so the operator estimates can be reset between
+ * runs.
+ */
+#include "keyer.c"
+
+/* wt-keyer test */
+#include "sim.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Text keyed by the simulated operator */
+static const char Text[] =
+    "CQ CQ DE DF5WC DF5WC PSE K TNX FER CALL UR RST 599 5NN NAME IS ULI "
+    "QTH FILDERSTADT HW CPY 73 ES GL";
+
+/* Number of times the text is keyed per run and number of runs with
+ * different random numbers per set
+ */
+#define REPEAT          3
+#define SEEDS           20
+
+/* A timing set: Configured speed, speed of the operator, factor for the
+ * operator's spaces, contact bounce and the allowed character error rates
+ * in percent for each jitter value.
+ */
+typedef struct {
+    unsigned    CfgWpm;
+    unsigned    OpWpm;
+    double      SpaceFactor;
+    bool        Bounce;
+    double      MaxError[4];
+} TimingSet;
+
+static const double Jitter[4] = { 0.05, 0.10, 0.15, 0.20 };
+
+static const TimingSet Sets[] = {
+    { 20, 20, 1.0, false, {  1.0,  2.0, 10.0, 25.0 } },
+    { 20, 12, 1.0, false, {  1.0,  2.0, 10.0, 25.0 } },
+    { 20, 30, 1.0, false, {  5.0,  5.0, 10.0, 25.0 } },
+    { 10, 25, 1.0, false, {  5.0,  5.0, 15.0, 25.0 } },
+    { 20, 20, 1.5, false, {  1.0,  2.0, 10.0, 25.0 } },
+    { 20, 20, 1.0, true,  {  1.0,  2.0, 10.0, 25.0 } },
+    {  5,  5, 1.0, false, {  1.0,  2.0, 10.0, 25.0 } },
+};
+
+/* Key marks of one run in ticks */
+#define MAX_MARKS       4096
+static uint32_t MarkStart[MAX_MARKS];
+static uint32_t MarkEnd[MAX_MARKS];
+static unsigned MarkCount;
+static unsigned MarkIndex;
+
+/* Random number generator state */
+static uint32_t Rand;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static double Uniform(void)
+/* Return a random number in 0..1 */
+{
+    Rand ^= Rand << 13;
+    Rand ^= Rand >> 17;
+    Rand ^= Rand << 5;
+    return (Rand + 0.5) / 4294967296.0;
+}
+
+
+
+static double Gauss(void)
+/* Return a normally distributed random number */
+{
+    return sqrt(-2.0 * log(Uniform())) * cos(6.283185307179586 * Uniform());
+}
+
+
+
+static uint32_t Length(double Units, double Unit, double Jit)
+/* Return a jittered length in ticks */
+{
+    double L = Units * Unit * (1.0 + Gauss() * Jit);
+    return (L < 1.0)? 1 : (uint32_t) (L + 0.5);
+}
+
+
+
+static void AddMark(uint32_t Start, uint32_t End)
+/* Add a key mark */
+{
+    if (MarkCount < MAX_MARKS) {
+        MarkStart[MarkCount] = Start;
+        MarkEnd[MarkCount] = End;
+        ++MarkCount;
+    }
+}
+
+
+
+static unsigned MakeMarks(const TimingSet* S, double Jit, char* Ref)
+/* Create the key marks for the text and the reference characters without
+ * spaces. Returns the number of characters.
+ */
+{
+    double Unit = 1.2 / S->OpWpm * CLOCK_HZ / TICK_CLOCKS;
+    double Space = Unit * S->SpaceFactor;
+    unsigned Chars = 0;
+    uint32_t T = 1000;
+    MarkCount = 0;
+    for (unsigned R = 0; R < REPEAT; ++R) {
+        for (const char* P = Text; *P; ++P) {
+            if (*P == ' ') {
+                /* Extend the character space to a word space */
+                T += Length(4, Space, Jit);
+                continue;
+            }
+            CwChar C = AsciiToCw(*P);
+            while (CwLength(C) > 0) {
+                uint32_t Start = T;
+                T += Length((CwFirstElement(C) == EL_DIT)? 1 : 3, Unit, Jit);
+                AddMark(Start, T);
+                if (S->Bounce) {
+                    /* A short bounce one to two milliseconds after opening */
+                    uint32_t B = T + MSEC(1, 0) + Uniform() * MSEC(1, 0);
+                    AddMark(B, B + MSEC(0, 500));
+                }
+                C = CwRemoveFirst(C);
+                T += Length(CwLength(C)? 1 : 3, Space, Jit);
+            }
+            Ref[Chars++] = *P;
+        }
+    }
+    Ref[Chars] = '\0';
+    return Chars;
+}
+
+
+
+static uint8_t KeyInput(uint32_t Tick)
+/* Return the straight key state for a tick */
+{
+    while (MarkIndex < MarkCount && Tick >= MarkEnd[MarkIndex]) {
+        ++MarkIndex;
+    }
+    return (MarkIndex < MarkCount && Tick >= MarkStart[MarkIndex])?
+           KEY_DIT : KEY_NONE;
+}
+
+
+
+static unsigned Distance(const char* A, const char* B)
+/* Return the edit distance of two strings */
+{
+    static unsigned Row[2][1024];
+    unsigned LB = strlen(B);
+    for (unsigned J = 0; J <= LB; ++J) {
+        Row[0][J] = J;
+    }
+    unsigned I;
+    for (I = 1; A[I - 1]; ++I) {
+        unsigned* P = Row[(I - 1) & 1];
+        unsigned* C = Row[I & 1];
+        C[0] = I;
+        for (unsigned J = 1; J <= LB; ++J) {
+            unsigned D = P[J - 1] + (A[I - 1] != B[J - 1]);
+            if (P[J] + 1 < D) {
+                D = P[J] + 1;
+            }
+            if (C[J - 1] + 1 < D) {
+                D = C[J - 1] + 1;
+            }
+            C[J] = D;
+        }
+    }
+    return Row[(I - 1) & 1][LB];
+}
+
+
+
+static double Run(const TimingSet* S, double Jit)
+/* Key the text with one timing set and jitter and return the character
+ * error rate of the decoder.
+ */
+{
+    static char Ref[1024];
+    static char Out[1024];
+    unsigned Chars = MakeMarks(S, Jit, Ref);
+    unsigned Count = 0;
+
+    /* Start with a fresh estimate at the configured speed */
+    SetCwWpm(S->CfgWpm);
+    SkDitTime = 0;
+    MarkIndex = 0;
+    SimReset(0, KeyInput);
+    SetupKeyer();
+    while (SimTicks() < MarkEnd[MarkCount - 1] + 20 * ElementTime(ET_UNIT)) {
+        if (Keyer() && Count < sizeof(Out) - 1) {
+            char C = CwToAscii(GetKeyedChar());
+            Out[Count++] = (C == (char) 0xFF)? '#' : C;
+        }
+        TxBufClear(&TxBuf);
+        WaitWakeUp();
+    }
+    Out[Count] = '\0';
+    return 100.0 * Distance(Ref, Out) / Chars;
+}
+
+
+
+int main(void)
+{
+    SetupTimer();
+    SetupCw();
+    StraightKey = true;
+
+    unsigned Failed = 0;
+    printf("straight: IRQ_HZ %5u, character error rate for jitter "
+           "5/10/15/20%%\n", IRQ_HZ);
+    for (unsigned I = 0; I < sizeof(Sets) / sizeof(Sets[0]); ++I) {
+        const TimingSet* S = &Sets[I];
+        printf("straight:   cfg %2u, op %2u, spaces x%.1f%s:", S->CfgWpm,
+               S->OpWpm, S->SpaceFactor, S->Bounce? ", bounce" : "        ");
+        for (unsigned J = 0; J < 4; ++J) {
+            double Error = 0.0;
+            for (unsigned Seed = 1; Seed <= SEEDS; ++Seed) {
+                Rand = Seed * 2654435761U;
+                Error += Run(S, Jitter[J]);
+            }
+            Error /= SEEDS;
+            bool Ok = Error <= S->MaxError[J];
+            printf(" %5.1f%%%s", Error, Ok? "" : "!");
+            Failed += !Ok;
+        }
+        printf("\n");
+    }
+    printf("straight: %s\n", Failed? "FAILED" : "ok");
+    return Failed? 1 : 0;
+}
+
+
+
@@ -0,0 +1,181 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 txdelay.c                                 */
+/*                                                                           */
+/*                 TX delay test for the walkie-talkie keyer                 */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "cwqueue.h"
+#include "rigctrl.h"
+#include "timer.h"
+#include "tone.h"
+#include "txbuffer.h"
+
+/* wt-keyer test */
+#include "sim.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Text sent at each speed. Dits give the most changes in TxBuf. */
+static const char Text[] = "PARIS 55555 HHHHH";
+
+/* Maximum number of marks recorded */
+#define MAX_MARKS       64
+
+/* A mark as seen on the sidetone or the TX tone */
+typedef struct {
+    uint32_t    Start;
+    uint32_t    Len;
+} Mark;
+
+/* Marks seen on one of the outputs */
+typedef struct {
+    bool        On;
+    unsigned    Count;
+    Mark        Marks[MAX_MARKS];
+} Output;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static void Record(Output* O, bool On)
+/* Record a change of an output */
+{
+    if (On && !O->On) {
+        if (O->Count < MAX_MARKS) {
+            O->Marks[O->Count].Start = SimTicks();
+        }
+    } else if (!On && O->On) {
+        if (O->Count < MAX_MARKS) {
+            O->Marks[O->Count].Len = SimTicks() - O->Marks[O->Count].Start;
+        }
+        ++O->Count;
+    }
+    O->On = On;
+}
+
+
+
+static bool Differs(uint32_t A, uint32_t B)
+/* Compare two times, allowing one tick difference */
+{
+    return A > B + 1 || B > A + 1;
+}
+
+
+
+static unsigned Run(unsigned Wpm)
+/* Send the text at the given speed via a CW queue and TxSend. Returns the
+ * number of marks that were not transmitted exactly as on the sidetone.
+ */
+{
+    static CwQueue Q;
+    static Output Side, Tx;
+    Q.Tx = true;
+    Side.On = Tx.On = false;
+    Side.Count = Tx.Count = 0;
+
+    SetCwWpm(Wpm);
+    SimReset(0, 0);
+    TxBufClear(&TxBuf);
+    TxAbort();
+    for (const char* T = Text; *T != '\0'; ++T) {
+        CwQueuePut(&Q, (*T == ' ')? CWQ_SPACE : AsciiToCw(*T));
+    }
+
+    /* Run until everything is sent, but no longer than a minute */
+    while (SimTicks() < 60UL * IRQ_HZ) {
+        RunCwQueue(&Q);
+        Record(&Side, (TCCR1A & (1 << COM1A0)) != 0);
+        TxSend();
+        Record(&Tx, (TCCR1A & (1 << COM1B0)) != 0);
+        if (Q.State == CWQS_IDLE && TxBufCount(&TxBuf) == 0 && !Tx.On) {
+            break;
+        }
+        WaitWakeUp();
+    }
+
+    /* The TX marks must be the sidetone marks delayed by TxDelay */
+    unsigned Errors = (Side.Count > Tx.Count)? Side.Count - Tx.Count :
+                                               Tx.Count - Side.Count;
+    unsigned Count = (Side.Count < Tx.Count)? Side.Count : Tx.Count;
+    for (unsigned I = 0; I < Count && I < MAX_MARKS; ++I) {
+        const Mark* S = &Side.Marks[I];
+        const Mark* T = &Tx.Marks[I];
+        if (Differs(T->Start, S->Start + TxDelay) || Differs(T->Len, S->Len)) {
+            ++Errors;
+        }
+    }
+    return Errors;
+}
+
+
+
+int main(void)
+{
+    SetupTimer();
+    SetupCw();
+    SetupRigCtrl();
+
+    unsigned Failed = 0;
+    for (unsigned W = WPM_MIN; W <= WPM_MAX; ++W) {
+        unsigned Errors = Run(W);
+        if (Errors > 0) {
+            printf("txdelay: %2u WPM, %u marks not transmitted correctly\n",
+                   W, Errors);
+            ++Failed;
+        }
+    }
+    printf("txdelay: IRQ_HZ %5u, \"%s\" at %u..%u WPM with %u ms TX delay: "
+           "%s\n", IRQ_HZ, Text, WPM_MIN, WPM_MAX, TXDELAY_DEFAULT,
+           Failed? "FAILED" : "ok");
+    return Failed? 1 : 0;
+}
+
+
+
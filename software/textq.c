@@ -0,0 +1,181 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  textq.c                                  */
+/*                                                                           */
+/*                   Text queue for the walkie-talkie keyer                  */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* wt-keyer */
+#include "cw.h"
+#include "cwqueue.h"
+#include "textq.h"
+#include "timer.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* The queue sends via TxBuf. Tx is set by SetupTextQ, so the queue doesn't
+ * need initialized data.
+ */
+static CwQueue TextQ;
+
+/* Hold at the next character boundary until HoldTimer expires */
+static SwTimer HoldTimer;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void SetupTextQ(void)
+/* Module setup */
+{
+    TextQ.Tx = true;
+}
+
+
+
+bool TextQPut(uint16_t Item)
+/* Add an item to the text queue. Returns false if the queue is full. */
+{
+    return CwQueuePut(&TextQ, Item);
+}
+
+
+
+bool TextQPutChar(char C)
+/* Add an ASCII character to the text queue. A blank is a word space, unknown
+ * characters are ignored. Returns false if the queue is full.
+ */
+{
+    if (C == ' ') {
+        return TextQPut(CWQ_SPACE);
+    }
+    CwChar Cw = AsciiToCw(C);
+    return (Cw == 0x0000)? true : TextQPut(Cw);
+}
+
+
+
+bool TextQPutString(const char* S)
+/* Add an ASCII string to the text queue. Returns false if the queue is full,
+ * in which case only part of the string was added.
+ */
+{
+    while (*S) {
+        if (!TextQPutChar(*S++)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+bool TextQPutNumber(uint16_t Number, uint8_t Digits)
+/* Add a number with the given digits to the text queue. Returns false if the
+ * queue is full, in which case only part of the number was added.
+ */
+{
+    if (Digits > 1 && !TextQPutNumber(Number / 10U, Digits - 1)) {
+        return false;
+    }
+    return TextQPutChar('0' + (uint8_t) (Number % 10U));
+}
+
+
+
+void TextQClear(void)
+/* Remove all items from the text queue and abort sending */
+{
+    CwQueueClear(&TextQ);
+    TextQ.Held = false;
+    StopSwTimer(&HoldTimer);
+}
+
+
+
+void TextQHold(void)
+/* Hold the text queue at the next character boundary. Sending continues
+ * after a word pause without another call.
+ */
+{
+    TextQ.Held = true;
+    StartSwTimer(&HoldTimer, ElementTime(ET_WORD_PAUSE));
+}
+
+
+
+bool TextQSending(void)
+/* Check if the text queue is sending a character or the pause after it, so
+ * nothing else may be sent before the pause has ended.
+ */
+{
+    return CwQueueSending(&TextQ);
+}
+
+
+
+bool TextQBusy(void)
+/* Check if the text queue has something to send */
+{
+    return TextQ.State != CWQS_IDLE || TextQ.In != TextQ.Out;
+}
+
+
+
+void RunTextQ(void)
+/* Send the text queue. Places the necessary data into TxBuf so that the
+ * morse code can be sent. Must be called in regular intervals.
+ */
+{
+    /* A hold ends a word pause after the last call to TextQHold */
+    if (TextQ.Held && SwTimerExpired(&HoldTimer)) {
+        TextQ.Held = false;
+    }
+
+    /* Memories are played by the queue, there are no other special items */
+    RunCwQueue(&TextQ);
+}
+
+
+
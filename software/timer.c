@@ -48,9 +48,50 @@
 
 
 
-/* T2 register values */
-#define T2_PRESCALER    64UL
-#define T2_COMPARE      ((uint8_t) (CLOCK_HZ / (T2_PRESCALER * IRQ_HZ)))
+/* T2 clock select bits for the prescaler chosen in timerdefs.h */
+#if T2_PRESCALER == 1
+  #define T2_CS         ((0 << CS22) | (0 << CS21) | (1 << CS20))
+#elif T2_PRESCALER == 8
+  #define T2_CS         ((0 << CS22) | (1 << CS21) | (0 << CS20))
+#elif T2_PRESCALER == 32
+  #define T2_CS         ((0 << CS22) | (1 << CS21) | (1 << CS20))
+#elif T2_PRESCALER == 64
+  #define T2_CS         ((1 << CS22) | (0 << CS21) | (0 << CS20))
+#else
+  #define T2_CS         ((1 << CS22) | (0 << CS21) | (1 << CS20))
+#endif
+
+/* In CTC mode the timer counts from zero up to and including the compare
+ * value, so that is one less than the period.
+ */
+#define T2_COMPARE      ((uint8_t) (T2_PERIOD - 1))
+
+/* Times are calculated using the real rate, but the ISR derives milliseconds
+ * for the buttons from IRQ_HZ, so the real rate must be close.
+ */
+#if TICK_CLOCKS * IRQ_HZ * 100 > CLOCK_HZ * 101 || \
+    TICK_CLOCKS * IRQ_HZ * 100 < CLOCK_HZ * 99
+  #error "Real IRQ rate differs more than 1% from IRQ_HZ"
+#endif
+
+/* Length of a timer 2 clock in nanoseconds */
+#define T2_CLOCK_NS     (T2_PRESCALER * 1000000000UL / CLOCK_HZ)
+
+/* Main loop wakeup */
+volatile Timer WakeTime;
+volatile uint8_t WakeUp;
+
+/* Load statistics */
+volatile uint8_t IsrMaxTime;    /* In timer 2 clocks */
+static uint16_t BusyTicks;      /* Ticks while awake */
+static uint16_t IdleTicks;      /* Ticks while sleeping */
+static Timer AwakeSince;        /* Tick of the last wakeup */
+
+/* List of running software timers sorted by expiry time */
+static SwTimer* SwTimers;
+
+/* Timer used by Sleep() */
+static SwTimer SleepTimer;
 
 
 
@@ -60,6 +101,69 @@
 
 
 
+static void SetWakeTime(void)
+/* Set the wakeup deadline from the first running software timer */
+{
+    /* Without a running timer, move the deadline as far into the future as
+     * possible. The deadline is read by the ISR, so we must disable
+     * interrupts while changing it.
+     */
+    Timer T = SwTimers? SwTimers->Expires : GetTicks() + 0x7FFF;
+    cli();
+    WakeTime = T;
+    sei();
+}
+
+
+
+static void InsertSwTimer(SwTimer* T)
+/* Insert a software timer into the list of running timers */
+{
+    /* Timers with the same expiry time expire in the order they were
+     * started.
+     */
+    SwTimer** P = &SwTimers;
+    while (*P && (int16_t) ((*P)->Expires - T->Expires) <= 0) {
+        P = &(*P)->Next;
+    }
+    T->Next = *P;
+    *P = T;
+    T->Running = true;
+}
+
+
+
+static void RemoveSwTimer(SwTimer* T)
+/* Remove a running software timer from the list */
+{
+    SwTimer** P = &SwTimers;
+    while (*P != T) {
+        P = &(*P)->Next;
+    }
+    *P = T->Next;
+    T->Running = false;
+}
+
+
+
+static void RunSwTimers(void)
+/* Handle all software timers that have expired */
+{
+    /* Since the list is sorted, we're done with the first timer that has not
+     * expired.
+     */
+    Timer Now = GetTicks();
+    SwTimer* T;
+    while ((T = SwTimers) != 0 && (int16_t) (Now - T->Expires) >= 0) {
+        SwTimers = T->Next;
+        T->Running = false;
+        T->Expired = true;
+    }
+    SetWakeTime();
+}
+
+
+
 void SetupTimer(void)
 /* Setup the irq timer ticker */
 {
@@ -70,13 +174,16 @@ void SetupTimer(void)
     TCCR2  = (0 << FOC2) |
              (1 << WGM21) | (0 << WGM20) |              /* CTC mode */
              (0 << COM21) | (0 << COM20) |              /* OC2 disconnected */
-             (1 << CS22) | (0 << CS21) | (0 << CS20);   /* Prescaler 64 */
+             T2_CS;                                     /* Prescaler */
     TIMSK  = (1 << OCIE2);
 
     /* Enable sleep mode and interrupts */
     set_sleep_mode(SLEEP_MODE_IDLE);
     sleep_enable();
     sei();
+
+    /* Start measuring the load */
+    ResetLoadStats();
 }
 
 
@@ -84,10 +191,119 @@ void SetupTimer(void)
 void Sleep(uint16_t Ticks)
 /* Sleep for a certain amount of time */
 {
-    Timer T = StartTimer();
-    do {
-        sleep_cpu();
-    } while (ElapsedTime(T) < Ticks);
+    StartSwTimer(&SleepTimer, Ticks);
+    while (!SwTimerExpired(&SleepTimer)) {
+        WaitWakeUp();
+    }
+
+    /* Input changes that woke us up must be seen by the main loop */
+    WakeNow();
+}
+
+
+
+void StartSwTimerAt(SwTimer* T, Timer Expires)
+/* Start a software timer that expires at tick Expires, which must not be
+ * more than 0x7FFF ticks in the future. A running timer is restarted.
+ */
+{
+    if (T->Running) {
+        RemoveSwTimer(T);
+    }
+    T->Expires = Expires;
+    T->Expired = false;
+    InsertSwTimer(T);
+    SetWakeTime();
+}
+
+
+
+void StopSwTimer(SwTimer* T)
+/* Stop a software timer and clear its expired flag */
+{
+    if (T->Running) {
+        RemoveSwTimer(T);
+        SetWakeTime();
+    }
+    T->Expired = false;
+}
+
+
+
+void WaitWakeUp(void)
+/* Sleep until an input has changed or a software timer expires, then handle
+ * the expired software timers.
+ */
+{
+    /* The flag is checked with interrupts disabled. Since the instruction
+     * following sei is always executed before a pending interrupt, we cannot
+     * go to sleep after the ISR has set the flag.
+     */
+    cli();
+    if (!WakeUp) {
+        /* Account the ticks since the last wakeup as busy. A pass of the
+         * main loop is usually much shorter than a tick, but a tick is
+         * as likely to fall into a busy period as its length says, so the
+         * counts have the right ratio on average.
+         */
+        Timer Start = GetTicks();
+        BusyTicks += Start - AwakeSince;
+
+        do {
+            sei();
+            sleep_cpu();
+            cli();
+        } while (!WakeUp);
+
+        /* Account the sleep time as idle. Both counts are scaled down
+         * together before they can overflow, so the ratio stays correct.
+         */
+        AwakeSince = GetTicks();
+        IdleTicks += AwakeSince - Start;
+        if (((BusyTicks | IdleTicks) & 0xC000U) != 0) {
+            BusyTicks >>= 1;
+            IdleTicks >>= 1;
+        }
+    }
+    WakeUp = false;
+    sei();
+
+    RunSwTimers();
+}
+
+
+
+uint8_t GetLoad(void)
+/* Return the time the CPU was busy since the last reset of the load
+ * statistics in percent.
+ */
+{
+    uint16_t Total = BusyTicks + IdleTicks;
+    return Total? (uint8_t) (((uint32_t) BusyTicks * 100 + Total / 2) / Total)
+                : 0;
+}
+
+
+
+uint16_t GetMaxIsrTime(void)
+/* Return the worst case ISR duration since the last reset of the load
+ * statistics in microseconds, including the interrupt latency.
+ */
+{
+    return (uint16_t) ((uint32_t) IsrMaxTime * T2_CLOCK_NS / 1000);
+}
+
+
+
+void ResetLoadStats(void)
+/* Reset the load statistics */
+{
+    cli();
+    BusyTicks = 0;
+    IdleTicks = 0;
+    AwakeSince = GetTicks();
+    IsrMaxTime = 0;
+    sei();
 }
 
 
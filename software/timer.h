@@ -38,6 +38,7 @@
 
 
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /* wt-keyer */
@@ -51,13 +52,47 @@
 
 
 
-/* Software timer types */
+/* Software timer types. A Timer wraps after 0x10000 ticks (16.4s at 4 kHz),
+ * a LongTimer after 0x100000000 ticks (12.4 days at 4 kHz).
+ */
 typedef uint16_t Timer;
+typedef uint32_t LongTimer;
+
+/* A software timer. Running timers are kept in a list sorted by expiry time,
+ * so the ISR has to compare the tick counter against the first one only. The
+ * fields must not be changed directly while the timer is running.
+ */
+typedef struct SwTimer SwTimer;
+struct SwTimer {
+    SwTimer*    Next;           /* Next running timer */
+    Timer       Expires;        /* Tick at which the timer expires */
+    bool        Running;        /* Timer is in the list */
+    bool        Expired;        /* Timer has expired since it was started */
+};
+
+/* Main loop wakeup. The ISR sets WakeUp if one of the inputs has changed or
+ * if the tick counter has reached WakeTime, which is the expiry time of the
+ * first running software timer. Both are shared with the ISR in timer-irq.S.
+ */
+volatile Timer WakeTime;
+volatile uint8_t WakeUp;
+
+/* Worst case ISR duration in timer 2 clocks including the interrupt latency.
+ * Updated by the ISR in timer-irq.S.
+ */
+volatile uint8_t IsrMaxTime;
 
-/* Define for times. Decimal places must be in range 0..999 */
-#if ((IRQ_HZ % 1000UL) != 0)
+/* Define for times. Decimal places must be in range 0..999. If the real
+ * tick rate isn't IRQ_HZ, the ticks per millisecond are used as a factor
+ * with 16 fraction bits, which works up to about 4 seconds.
+ */
+#if CLOCK_HZ != IRQ_HZ * TICK_CLOCKS
+  #define MSEC_FACTOR   \
+    ((uint32_t) ((CLOCK_HZ * 65536ULL + TICK_CLOCKS * 500UL) / \
+                 (TICK_CLOCKS * 1000UL)))
   #define MSEC(msec,usec) \
-    ((uint16_t)((uint32_t)(msec)*IRQ_HZ/1000UL + (uint32_t)(usec)*IRQ_HZ/1000000UL))
+    ((uint16_t)(((uint32_t)(msec)*MSEC_FACTOR + \
+                 (uint32_t)(usec)*MSEC_FACTOR/1000UL + 0x8000UL) >> 16))
 #else
   #define MSEC(msec,usec) \
     ((uint16_t)((msec)*(IRQ_HZ/1000UL) + (uint32_t)(usec)*IRQ_HZ/1000000UL))
@@ -77,12 +112,21 @@ void SetupTimer(void);
 Timer GetTicks(void);
 /* Return the current timer ticks (timer-irq.S) */
 
+LongTimer GetLongTicks(void);
+/* Return the current timer ticks as 32 bit value (timer-irq.S) */
+
 static inline Timer StartTimer(void)
 /* Return a timer start value */
 {
     return (Timer)GetTicks();
 }
 
+static inline LongTimer StartLongTimer(void)
+/* Return a long timer start value */
+{
+    return GetLongTicks();
+}
+
 static inline void IncTimer(Timer* T, uint16_t Ticks)
 /* Add a certain amount to a timer */
 {
@@ -97,9 +141,75 @@ static inline uint16_t ElapsedTime(Timer T)
     return GetTicks() - T;
 }
 
+static inline uint32_t LongElapsedTime(LongTimer T)
+/* Return the elapsed time since start of the long timer. Result is in IRQ_HZ
+ * units.
+ */
+{
+    return GetLongTicks() - T;
+}
+
 void Sleep(uint16_t Ticks);
 /* Sleep for a certain amount of time */
 
+void StartSwTimerAt(SwTimer* T, Timer Expires);
+/* Start a software timer that expires at tick Expires, which must not be
+ * more than 0x7FFF ticks in the future. A running timer is restarted.
+ */
+
+static inline void StartSwTimer(SwTimer* T, uint16_t Ticks)
+/* Start a software timer that expires Ticks ticks from now */
+{
+    StartSwTimerAt(T, GetTicks() + Ticks);
+}
+
+static inline void ContinueSwTimer(SwTimer* T, uint16_t Ticks)
+/* Restart an expired software timer so that it expires Ticks ticks after its
+ * last expiry. Used to time a sequence of intervals without drift.
+ */
+{
+    StartSwTimerAt(T, T->Expires + Ticks);
+}
+
+void StopSwTimer(SwTimer* T);
+/* Stop a software timer and clear its expired flag */
+
+static inline bool SwTimerRunning(const SwTimer* T)
+/* Return true if the software timer is running */
+{
+    return T->Running;
+}
+
+static inline bool SwTimerExpired(const SwTimer* T)
+/* Return true if the software timer has expired since it was started */
+{
+    return T->Expired;
+}
+
+static inline void WakeNow(void)
+/* Make sure the main loop makes another pass without sleeping */
+{
+    WakeUp = true;
+}
+
+void WaitWakeUp(void);
+/* Sleep until an input has changed or a software timer expires, then handle
+ * the expired software timers.
+ */
+
+uint8_t GetLoad(void);
+/* Return the time the CPU was busy since the last reset of the load
+ * statistics in percent.
+ */
+
+uint16_t GetMaxIsrTime(void);
+/* Return the worst case ISR duration since the last reset of the load
+ * statistics in microseconds, including the interrupt latency.
+ */
+
+void ResetLoadStats(void);
+/* Reset the load statistics */
+
 
 
 /* End of timer.h */
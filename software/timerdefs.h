@@ -0,0 +1,113 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                timerdefs.h                                */
+/*                                                                           */
+/*                   Timer definitions shared with the ISR                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 2025,      Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@df5wc.org                                               */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef WTKEYER_TIMERDEFS_H
+#define WTKEYER_TIMERDEFS_H
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* CPU clock. The board uses an 8 MHz ceramic resonator. */
+#ifndef CLOCK_HZ
+  #define CLOCK_HZ      8000000
+#endif
+
+/* Frequency of the timer interrupt. May be overridden from the command line
+ * to build images with a different timer resolution. The value is also used
+ * by the assembler, so it must not have a type suffix.
+ */
+#ifndef IRQ_HZ
+  #define IRQ_HZ        4000
+#endif
+
+/* Timer ticks per millisecond. Buttons are read and debounced once per
+ * millisecond independent of IRQ_HZ. The ISR derives the millisecond from the
+ * low bits of the tick counter, so this must be a power of two.
+ */
+#define TICKS_PER_MSEC  (IRQ_HZ / 1000)
+
+#if (IRQ_HZ % 1000) != 0 || TICKS_PER_MSEC == 0 || \
+    (TICKS_PER_MSEC & (TICKS_PER_MSEC - 1)) != 0
+  #error "IRQ_HZ must be 1000 times a power of two"
+#endif
+
+/* Timer 2 prescaler. Use the smallest one that allows the period to fit
+ * into the 8 bit compare register, since this gives the most exact IRQ rate.
+ */
+#if CLOCK_HZ / IRQ_HZ <= 256
+  #define T2_PRESCALER  1UL
+#elif CLOCK_HZ / (8UL * IRQ_HZ) <= 256
+  #define T2_PRESCALER  8UL
+#elif CLOCK_HZ / (32UL * IRQ_HZ) <= 256
+  #define T2_PRESCALER  32UL
+#elif CLOCK_HZ / (64UL * IRQ_HZ) <= 256
+  #define T2_PRESCALER  64UL
+#elif CLOCK_HZ / (128UL * IRQ_HZ) <= 256
+  #define T2_PRESCALER  128UL
+#else
+  #error "IRQ_HZ too low for CLOCK_HZ"
+#endif
+
+/* Timer 2 period in timer clocks, rounded */
+#define T2_PERIOD       \
+    ((CLOCK_HZ + T2_PRESCALER * IRQ_HZ / 2) / (T2_PRESCALER * IRQ_HZ))
+
+/* CPU clocks per tick. The real tick rate is CLOCK_HZ / TICK_CLOCKS. This is
+ * IRQ_HZ only if CLOCK_HZ is a multiple of IRQ_HZ, at 16kHz the real rate is
+ * 15873Hz. All times derived from seconds, like element lengths and MSEC(),
+ * use the real rate.
+ */
+#define TICK_CLOCKS     (T2_PRESCALER * T2_PERIOD)
+
+/* Timers and deadlines must not be more than 0x7FFF ticks in the future.
+ * The longest single interval used is 2 seconds. Longer delays, like the TX
+ * off delay at low speeds, are timed in steps.
+ */
+#if IRQ_HZ > 16000
+  #error "IRQ_HZ must not be larger than 16000"
+#endif
+
+
+
+/* End of timerdefs.h */
+#endif
+
+
+
@@ -127,35 +127,22 @@ void SetToneFreq(uint16_t Freq)
 
 
 
-void PlayTone(uint16_t Freq, uint16_t Ticks)
-/* Output a tone with the given frequency and duration */
+void StartTone(uint16_t Freq)
+/* Start a tone with the given frequency on the sidetone. This will not
+ * influence the current tone frequency.
+ */
 {
     SetCompareRegA(Freq);
     SideToneStart();
-    Sleep(Ticks);
-    SideToneDone();
-    SetCompareRegA(ToneFreq);
-}
-
-
-
-void SuccessTone(void)
-/* Output a short tone that signals a successful operation. This will be
- * always output via the sidetone and will not influence the current tone
- * frequency.
- */
-{
-    PlayTone(TONEFREQ_SUCCESS, MSEC(70, 0));
 }
 
 
 
-void FailureTone(void)
-/* Output a short tone that signals a failed operation. This will be always
- * output via the sidetone and will not influence the current tone frequency.
- */
+void EndTone(void)
+/* End a tone started with StartTone() */
 {
-    PlayTone(TONEFREQ_FAILURE, MSEC(100, 0));
+    SideToneDone();
+    SetCompareRegA(ToneFreq);
 }
 
 
@@ -76,19 +76,13 @@ void SetToneFreq(uint16_t Freq);
  * the tx tone.
  */
 
-void PlayTone(uint16_t Freq, uint16_t Ticks);
-/* Output a tone with the given frequency and duration */
-
-void SuccessTone(void);
-/* Output a short tone that signals a successful operation. This will be
- * always output via the sidetone and will not influence the current tone
- * frequency.
+void StartTone(uint16_t Freq);
+/* Start a tone with the given frequency on the sidetone. This will not
+ * influence the current tone frequency.
  */
 
-void FailureTone(void);
-/* Output a short tone that signals a failed operation. This will be always
- * output via the sidetone and will not influence the current tone frequency.
- */
+void EndTone(void);
+/* End a tone started with StartTone() */
 
 static inline void SideToneStart(void)
 /* Start sidetone output */
@@ -49,3 +49,27 @@ TxBuffer TxBuf;
 
 
 
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void TxBufPush(TxBuffer* B, Timer T, bool On)
+/* Add a state change to the buffer */
+{
+    /* If the buffer is full, the oldest entry is dropped, so the entries
+     * stay in order. This happens only with a lot of contact bounce on a
+     * straight key.
+     */
+    B->Buf[B->In] = (TxBufferEntry){ .On = On, .Time = T };
+    B->In = (B->In + 1) & (TXBUF_SIZE - 1);
+    if (B->Count < TXBUF_SIZE) {
+        ++B->Count;
+    } else {
+        B->Out = B->In;
+    }
+}
+
+
+
@@ -52,6 +52,12 @@
 
 
 
+/* Size of the transmit buffer. It must hold all changes within the longest
+ * TX delay at the highest speed, which is checked in rigctrl.c. Must be a
+ * power of two.
+ */
+#define TXBUF_SIZE      64
+
 /* Transmit buffer */
 typedef struct {
     bool        On;
@@ -61,7 +67,7 @@ typedef struct {
     uint8_t         Count;      /* Number of elements in the buffer */
     uint8_t         In;         /* Input pointer */
     uint8_t         Out;        /* Output pointer */
-    TxBufferEntry   Buf[16];    /* Element buffer. Must be 2^n in size. */
+    TxBufferEntry   Buf[TXBUF_SIZE];    /* Element buffer */
 } TxBuffer;
 TxBuffer TxBuf;
 
@@ -80,17 +86,8 @@ static inline void TxBufClear(TxBuffer* B)
     B->Out   = 0;
 }
 
-static inline void TxBufPush(TxBuffer* B, Timer T, bool On)
-{
-    /* If the buffer is full, we overwrite existing data. That's not a problem
-     * since this happens in situations when the buffer is unused anyway.
-     */
-    B->Buf[B->In] = (TxBufferEntry){ .On = On, .Time = T };
-    B->In = (B->In + 1) & (sizeof(B->Buf)/sizeof(B->Buf[0]) - 1);
-    if (B->Count < sizeof(B->Buf)/sizeof(B->Buf[0])) {
-        ++B->Count;
-    }
-}
+void TxBufPush(TxBuffer* B, Timer T, bool On);
+/* Add a state change to the buffer */
 
 static inline const TxBufferEntry* TxBufOut(TxBuffer* B)
 {
@@ -99,7 +96,7 @@ static inline const TxBufferEntry* TxBufOut(TxBuffer* B)
 
 static inline void TxBufDrop(TxBuffer* B)
 {
-    B->Out = (B->Out + 1) & (sizeof(B->Buf)/sizeof(B->Buf[0]) - 1);
+    B->Out = (B->Out + 1) & (TXBUF_SIZE - 1);
     --B->Count;
 }
 